@@ -28,11 +28,13 @@ import {
 import {
     getDatabase,
     ref,
-    set,
-    get,
     onValue,
 } from "https://www.gstatic.com/firebasejs/10.12.2/firebase-database.js";
 
+import { LanChannel, LanTransport, servoPose } from "./lan.js";
+import { StateStore } from "./store.js";
+import { RtdbTransport, WriteBatcher } from "./writes.js";
+
 // ============================================================================
 //                              CONFIGURATION
 // ============================================================================
@@ -58,6 +60,62 @@ const database = getDatabase(firebaseApp);
 // const ESP32_IP_KEY = "esp32_ip_address";
 let messageTimeout;
 
+// Direct connection to the ESP32 for joystick moves, see lan.js
+const lanChannel = new LanChannel();
+
+// Local copy of the selected device's desired state, kept current by one
+// subscription
+const deviceState = new StateStore();
+
+// Laser DeviceId from src/command.h, carried in servo frames
+const DEVICE_LASER = 3;
+
+// Every tower keeps its state under DEVICE_NAMESPACE/<chip id>. The device
+// picked last is remembered under SELECTED_DEVICE_KEY.
+const DEVICE_NAMESPACE = "devices";
+const SELECTED_DEVICE_KEY = "selected_device";
+
+// Under each tower: DESIRED_STATE, which the dashboard writes and the tower
+// streams, and beside it what the tower writes (LAN_NODE, reported,
+// telemetry, diagnostics). Only these two are subscribed, so telemetry
+// flushes never reach the dashboard.
+const DESIRED_STATE = "state";
+const LAN_NODE = "lan";
+
+// Writes go to the selected device's desired state, set by selectDevice()
+const rtdbTransport = new RtdbTransport(database, deviceState);
+
+// Every device write, batched per animation frame. Laser moves take the LAN
+// channel while it is open.
+const deviceWrites = new WriteBatcher(
+    new LanTransport(lanChannel, { "laser_servo/pose": DEVICE_LASER }, rtdbTransport)
+);
+
+// End the selected device's subscriptions
+let deviceSubscriptions = [];
+
+// ============================================================================
+//                              DESIRED STATE
+// ============================================================================
+/**
+ * Write one or more values of the selected device. They join the pending
+ * batch, which goes out as a single multi-path update under the device's
+ * desired state that also bumps its version. The ESP32 reports the version
+ * it has converged on under reported/version, so every change must go
+ * through here.
+ *
+ * @param {Object} values : RTDB path -> value (ex: {"heating_pad/state": 1})
+ * @returns {Promise} settles when the batch carrying the values is sent
+ */
+function writeDesired(values) {
+    return deviceWrites.write(values);
+}
+
+// Animation frames stop in a hidden tab, so send what is pending right away
+document.addEventListener("visibilitychange", () => {
+    if (document.hidden) deviceWrites.flush();
+});
+
 // DOM selector helper functions
 const $ = (selector) => document.querySelector(selector);
 const $$ = (selector) => Array.from(document.querySelectorAll(selector));
@@ -92,6 +150,7 @@ onAuthStateChanged(auth, (user) => {
         appSection?.classList.remove("hidden");
         if (signOutBtn) signOutBtn.hidden = false;
         if (userEmail) userEmail.textContent = user.email ?? "User";
+        if (isDashboard) loadDevices();
     } 
     else {
         authCard?.classList.remove("hidden");
@@ -261,24 +320,24 @@ function initDashboardControls() {
             ipLabel.style.display = "none";
         }
     }
-    refreshStatus();
-    
+
+    const picker = document.getElementById("device-picker");
+    if (picker) {
+        picker.addEventListener("change", () => selectDevice(picker.value));
+    }
+
     // ========================================================================
     //                              LISTENERS
     // ========================================================================
-    // Listener for temperature sensor state changes
-    const temperatureSensorRef = ref(database, "temperature_sensor/state");
-    onValue(temperatureSensorRef, (snapshot) => {
-        const state = snapshot.exists() ? (snapshot.val() === 1 ? "on" : "off") : "unknown";
-        updateDeviceStatus("temperature_sensor", state);
-    });
+    // The selected device's subscription (see selectDevice()) feeds the
+    // store. Watchers below only run for values that changed.
 
-    // Listener for heating pad state changes
-    const heatingPadRef = ref(database, "heating_pad/state");
-    onValue(heatingPadRef, (snapshot) => {
-        // Convert Firebase value (0 or 1) to string ("off" or "on")
-        const state = snapshot.exists() ? (snapshot.val() === 1 ? "on" : "off") : "unknown";
-        updateDeviceStatus("heating_pad", state);
+    // Temperature sensor and heating pad state
+    deviceState.watch("temperature_sensor/state", (value) => {
+        updateDeviceStatus("temperature_sensor", stateName(value));
+    });
+    deviceState.watch("heating_pad/state", (value) => {
+        updateDeviceStatus("heating_pad", stateName(value));
     });
 
     // ========================================================================
@@ -309,6 +368,80 @@ function initDashboardControls() {
     initLaserJoystick();
 }
 
+// ============================================================================
+//                              DEVICE SELECTION
+// ============================================================================
+/**
+ * Fill the device picker with every tower under DEVICE_NAMESPACE and select
+ * the one picked last (or the first). Towers add themselves on boot. The
+ * list is read with a shallow REST query, which returns only the chip ids,
+ * so it costs the same however much state each tower holds.
+ */
+async function loadDevices() {
+    const picker = document.getElementById("device-picker");
+    if (!picker) return;
+
+    let ids;
+    try {
+        const token = await auth.currentUser.getIdToken();
+        const url = `${ref(database, DEVICE_NAMESPACE).toString()}.json?shallow=true&auth=${token}`;
+        const response = await fetch(url);
+        if (!response.ok) throw new Error(`HTTP ${response.status}`);
+        ids = Object.keys((await response.json()) ?? {}).sort();
+    }
+    catch (error) {
+        console.error("Device list error:", error);
+        showMessage(`Error loading devices: ${error.message}`, "error");
+        return;
+    }
+
+    picker.replaceChildren(...ids.map((id) => new Option(id, id)));
+    if (!ids.length) {
+        showMessage("No devices have connected yet", "error");
+        return;
+    }
+
+    const saved = localStorage.getItem(SELECTED_DEVICE_KEY);
+    picker.value = ids.includes(saved) ? saved : ids[0];
+    selectDevice(picker.value);
+}
+
+/**
+ * Point the dashboard at one tower: writes still pending go to the previous
+ * one, then the subscriptions, the local copy, the write root and the LAN
+ * channel all move to the new device.
+ *
+ * @param {string} id : chip id (ex: "a1b2c3d4e5f6")
+ */
+function selectDevice(id) {
+    const root = `${DEVICE_NAMESPACE}/${id}`;
+    const desiredRoot = `${root}/${DESIRED_STATE}`;
+    if (rtdbTransport.root === desiredRoot) return;
+
+    deviceWrites.flush();
+    deviceSubscriptions.forEach((unsubscribe) => unsubscribe());
+    deviceState.reset();
+    applyLanInfo(null);
+
+    rtdbTransport.root = desiredRoot;
+    deviceSubscriptions = [
+        onValue(ref(database, desiredRoot), (snapshot) => deviceState.apply(snapshot.val())),
+        onValue(ref(database, `${root}/${LAN_NODE}`), (snapshot) => applyLanInfo(snapshot.val())),
+    ];
+    localStorage.setItem(SELECTED_DEVICE_KEY, id);
+}
+
+/**
+ * Follow the selected ESP32's LAN address and session key
+ *
+ * @param {Object|null} info : its LAN_NODE, null if none
+ */
+function applyLanInfo(info) {
+    const ipInput = document.getElementById("esp32-ip");
+    if (ipInput) ipInput.value = info?.ip ?? "";
+    lanChannel.configure(info);
+}
+
 // ============================================================================
 //                          DEVICE CONTROL FUNCTIONS
 // ============================================================================
@@ -340,8 +473,7 @@ async function controlDevice(device, action) {
         
         const state = action === "on" ? 1 : 0;
         
-        const stateRef = ref(database, firebasePath);
-        await set(stateRef, state);
+        await writeDesired({ [firebasePath]: state });
 
         showMessage(`${formatDeviceName(device)} turned ${action}`, "success");
         updateDeviceStatus(device, action);
@@ -352,33 +484,51 @@ async function controlDevice(device, action) {
     }
 }
 
-// Refresh device status. When adding peripherals, add the device reading logic here
-async function refreshStatus() {
+/**
+ * Write the heating pad setpoint from the setpoint field. The firmware keeps
+ * the pad within half a degree of it while the pad is on; 0 turns regulation
+ * off and leaves the pad on.
+ * 
+ * Stored in tenths of a degree Celsius (ex: 30.5 C -> 305)
+ */
+async function controlSetpoint() {
     try {
-        const heatingPadRef = ref(database, "heating_pad/state");
-        const temperatureSensorRef = ref(database, "temperature_sensor/state");
-        
-        const heatingPadSnapshot = await get(heatingPadRef);
-        const temperatureSensorSnapshot = await get(temperatureSensorRef);
-        
-        const heatingPadState = heatingPadSnapshot.exists() 
-            ? (heatingPadSnapshot.val() === 1 ? "on" : "off") 
-            : "unknown";
-        const temperatureSensorState = temperatureSensorSnapshot.exists() 
-            ? (temperatureSensorSnapshot.val() === 1 ? "on" : "off") 
-            : "unknown";
-        
-        updateDeviceStatus("heating_pad", heatingPadState);
-        updateDeviceStatus("temperature_sensor", temperatureSensorState);
+        const input = document.getElementById("heating-pad-setpoint");
+        const celsius = parseFloat(input.value);
 
-        showMessage("Status updated", "success");
-    } 
+        if (isNaN(celsius) || celsius < 0 || celsius > 45) {
+            showMessage("Setpoint must be between 0 and 45 \u00B0C", "error");
+            return;
+        }
+
+        await writeDesired({ "heating_pad/setpoint": Math.round(celsius * 10) });
+        showMessage(`Heating pad setpoint set to ${celsius} \u00B0C`, "success");
+    }
     catch (error) {
-        console.error("Status refresh error:", error);
+        console.error("Setpoint error:", error);
         showMessage(`Error: ${error.message}`, "error");
     }
 }
 
+// Refresh device status from the local copy, which the subscription keeps
+// current. When adding peripherals, add the device reading logic here
+function refreshStatus() {
+    if (!deviceState.loaded) {
+        showMessage("Waiting for device status", "error");
+        return;
+    }
+
+    updateDeviceStatus("heating_pad", stateName(deviceState.get("heating_pad/state")));
+    updateDeviceStatus("temperature_sensor", stateName(deviceState.get("temperature_sensor/state")));
+
+    showMessage("Status updated", "success");
+}
+
+// Convert an RTDB state (0, 1 or missing) to "off", "on" or "unknown"
+function stateName(value) {
+    return value === null ? "unknown" : (value === 1 ? "on" : "off");
+}
+
 /**
  * Update device status indicator in the UI
  * 
@@ -417,30 +567,21 @@ function updateDeviceStatus(device, state) {
 //              VIRTUAL JOYSTICK CONTROL FOR CAMERA + LASER
 // ========================================================================
 
-function createJoystick(areaId, handleId, xPath, yPath) {
+// Moves are written as poses of both axes to posePath. The batch transport
+// sends them over the LAN channel when it is open and to the RTDB
+// otherwise, at most once per animation frame. Releasing writes the angles
+// themselves.
+function createJoystick(areaId, handleId, xPath, yPath, posePath, framePath) {
     const area = document.getElementById(areaId);
     const handle = document.getElementById(handleId);
 
     if (!area || !handle) return;
 
-    const xRef = ref(database, xPath);
-    const yRef = ref(database, yPath);
-
     let isActive = false;
-
-    // Adding Throttle. Will test to see if this actually works with tower.
-    const SEND_INTERVAL_MS = 50;
-    let lastSendTime = 0;
     let lastSentX = 90;
     let lastSentY = 90;
 
     function updateFromClientCoords(clientX, clientY) {
-        const now = Date.now();
-        if (now - lastSendTime < SEND_INTERVAL_MS) {
-            return;
-        }
-        lastSendTime = now;
-
         const rect = area.getBoundingClientRect();
         const centerX = rect.left + rect.width / 2;
         const centerY = rect.top + rect.height / 2;
@@ -464,11 +605,10 @@ function createJoystick(areaId, handleId, xPath, yPath) {
         lastSentX = xAngle;
         lastSentY = yAngle;
 
-        set(xRef, xAngle).catch((error) => {
-            console.error(`Error writing x angle to ${xPath}:`, error);
-        });
-        set(yRef, yAngle).catch((error) => {
-            console.error(`Error writing y angle to ${yPath}:`, error);
+        // Both axes travel together, so the ESP32 moves them as one pose.
+        // A move still pending is replaced rather than sent.
+        deviceWrites.write({ [posePath]: servoPose(xAngle, yAngle) }).catch((error) => {
+            console.error(`Error writing pose to ${posePath}:`, error);
         });
     }
 
@@ -501,11 +641,13 @@ function createJoystick(areaId, handleId, xPath, yPath) {
         isActive = false;
         handle.style.transform = "translate(-50%, -50%)";
 
-        set(xRef, 90).catch((error) => {
-            console.error(`Error resetting x angle to ${xPath}:`, error);
-        });
-        set(yRef, 90).catch((error) => {
-            console.error(`Error resetting y angle to ${yPath}:`, error);
+        // The angles in the RTDB stay the source of truth, so the final
+        // position is written there however the moves went (and over the
+        // LAN as well when it is open). The pose in the same update has both
+        // axes return together. Clearing the frame keeps a stale one from
+        // being replayed when the ESP32 boots.
+        writeDesired({ [xPath]: 90, [yPath]: 90, [posePath]: servoPose(90, 90), [framePath]: null }).catch((error) => {
+            console.error(`Error resetting angles to ${xPath}, ${yPath}:`, error);
         });
 
         lastSentX = 90;
@@ -621,7 +763,9 @@ function initLaserJoystick() {
         "laser-joystick",
         "laser-joystick-handle",
         "laser_servo/x_angle",
-        "laser_servo/y_angle"
+        "laser_servo/y_angle",
+        "laser_servo/pose",
+        "laser_servo/frame"
     );
 }
 
@@ -633,32 +777,25 @@ function initCameraButtons() {
 
     if (!upBtn || !downBtn || !leftBtn || !rightBtn) return;
 
-    const xRef = ref(database, "camera_servo/x_angle");
-    const yRef = ref(database, "camera_servo/y_angle");
-
-    let x = 90;
-    let y = 90;
-
     const STEP = 30;
 
-    // Keep local values updated
-    onValue(xRef, (s) => x = s.exists() ? s.val() : 90);
-    onValue(yRef, (s) => y = s.exists() ? s.val() : 90);
+    // Current angles, from the local copy
+    const angle = (path) => deviceState.get(path) ?? 90;
 
     leftBtn.addEventListener("click", () => {
-        set(xRef, Math.max(0, x - STEP));
+        writeDesired({ "camera_servo/x_angle": Math.max(0, angle("camera_servo/x_angle") - STEP) });
     });
 
     rightBtn.addEventListener("click", () => {
-        set(xRef, Math.min(180, x + STEP));
+        writeDesired({ "camera_servo/x_angle": Math.min(180, angle("camera_servo/x_angle") + STEP) });
     });
 
     upBtn.addEventListener("click", () => {
-        set(yRef, Math.min(180, y + STEP));
+        writeDesired({ "camera_servo/y_angle": Math.min(180, angle("camera_servo/y_angle") + STEP) });
     });
 
     downBtn.addEventListener("click", () => {
-        set(yRef, Math.max(0, y - STEP));
+        writeDesired({ "camera_servo/y_angle": Math.max(0, angle("camera_servo/y_angle") - STEP) });
     });
 }
 
@@ -777,4 +914,5 @@ function formatDeviceName(device) {
 //                          GLOBAL ONCLICK FUNCTIONS
 // ============================================================================
 window.controlDevice = controlDevice;
+window.controlSetpoint = controlSetpoint;
 window.refreshStatus = refreshStatus;
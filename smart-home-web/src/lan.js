@@ -0,0 +1,285 @@
+/**
+ *          Description:        Binary servo frames and the direct LAN control
+ *                              channel to the ESP32.
+ *                              A frame (src/servo_frame.h) sets both axes of a
+ *                              gimbal in 10 bytes. When the ESP32 is reachable,
+ *                              LanTransport sends moves as frames straight to
+ *                              its WebSocket endpoint, skipping the few hundred
+ *                              ms the RTDB round trip takes even on the same
+ *                              WiFi. Otherwise they go to the RTDB as poses.
+ *                              The ESP32 publishes its address and a per-boot
+ *                              session key to /lan; every LAN packet carries a
+ *                              SipHash-2-4 tag keyed with it (src/lan_packet.h).
+ *
+ *                              Browsers block ws:// from an https:// page, so a
+ *                              hosted dashboard stays on the RTDB. Serve it
+ *                              over http on the LAN to use this channel.
+ * 
+ *          Author:             Eddie Kwak
+ *          Last Modified:      10/15/2026
+ */
+
+// ============================================================================
+//                              CONFIGURATION
+// ============================================================================
+// Frame and packet layout, see src/servo_frame.h and src/lan_packet.h
+const SERVO_FRAME_PULSES = 2;
+const SERVO_FRAME_SIZE = 10;
+const LAN_PACKET_SIZE = SERVO_FRAME_SIZE + 8;
+
+// Pulse widths for 0 and 180 degrees, as on the ESP32
+const SERVO_MIN_PULSE_US = 544;
+const SERVO_MAX_PULSE_US = 2400;
+
+// Wait before reopening a dropped connection
+const RECONNECT_DELAY_MS = 5000;
+
+// Packets on the LAN cost nothing in the RTDB, so moves go out every
+// animation frame
+const LAN_MIN_INTERVAL_MS = 0;
+
+// ============================================================================
+//                                 SIPHASH
+// ============================================================================
+const MASK_64 = (1n << 64n) - 1n;
+
+function rotl(value, bits) {
+    return ((value << bits) | (value >> (64n - bits))) & MASK_64;
+}
+
+function readU64(bytes, offset) {
+    let value = 0n;
+    for (let i = 7; i >= 0; i--) {
+        value = (value << 8n) | BigInt(bytes[offset + i]);
+    }
+    return value;
+}
+
+/**
+ * SipHash-2-4 of data, as in src/siphash.h.
+ *
+ * @param {Uint8Array} key : 16 byte key
+ * @param {Uint8Array} data : message
+ * @returns {BigInt} 64-bit tag
+ */
+export function siphash24(key, data) {
+    const k0 = readU64(key, 0);
+    const k1 = readU64(key, 8);
+    const v = [
+        k0 ^ 0x736f6d6570736575n,
+        k1 ^ 0x646f72616e646f6dn,
+        k0 ^ 0x6c7967656e657261n,
+        k1 ^ 0x7465646279746573n,
+    ];
+
+    function round() {
+        v[0] = (v[0] + v[1]) & MASK_64; v[1] = rotl(v[1], 13n); v[1] ^= v[0]; v[0] = rotl(v[0], 32n);
+        v[2] = (v[2] + v[3]) & MASK_64; v[3] = rotl(v[3], 16n); v[3] ^= v[2];
+        v[0] = (v[0] + v[3]) & MASK_64; v[3] = rotl(v[3], 21n); v[3] ^= v[0];
+        v[2] = (v[2] + v[1]) & MASK_64; v[1] = rotl(v[1], 17n); v[1] ^= v[2]; v[2] = rotl(v[2], 32n);
+    }
+
+    function compress(m) {
+        v[3] ^= m;
+        round();
+        round();
+        v[0] ^= m;
+    }
+
+    const whole = data.length & ~7;
+    for (let i = 0; i < whole; i += 8) {
+        compress(readU64(data, i));
+    }
+
+    // Last block: remaining bytes, length in the top byte
+    let last = BigInt(data.length & 0xFF) << 56n;
+    for (let i = whole; i < data.length; i++) {
+        last |= BigInt(data[i]) << BigInt(8 * (i - whole));
+    }
+    compress(last);
+
+    v[2] ^= 0xFFn;
+    for (let i = 0; i < 4; i++) round();
+    return v[0] ^ v[1] ^ v[2] ^ v[3];
+}
+
+// ============================================================================
+//                               SERVO FRAMES
+// ============================================================================
+// Clock-derived so a reloaded page is not taken for a replay. Shared by both
+// transports, since the ESP32 drops any frame older than the last it took.
+let frameSeq = (Math.floor(Date.now() / 10) - 1) >>> 0;
+
+function nextFrameSeq() {
+    // Serial number arithmetic, as the ESP32 compares them
+    const clock = Math.floor(Date.now() / 10) >>> 0;
+    frameSeq = ((clock - frameSeq) | 0) > 0 ? clock : (frameSeq + 1) >>> 0;
+    return frameSeq;
+}
+
+function angleToPulse(angle) {
+    const clamped = Math.max(0, Math.min(180, angle));
+    return SERVO_MIN_PULSE_US + Math.round(clamped * (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) / 180);
+}
+
+/**
+ * Encode a move of both gimbal axes as a frame with the next sequence number.
+ *
+ * @param {number} device : DeviceId from src/command.h (camera 2, laser 3)
+ * @param {number} xAngle : x angle, degrees
+ * @param {number} yAngle : y angle, degrees
+ * @returns {Uint8Array} frame bytes
+ */
+export function encodeServoFrame(device, xAngle, yAngle) {
+    const frame = new Uint8Array(SERVO_FRAME_SIZE);
+    const view = new DataView(frame.buffer);
+    view.setUint8(0, SERVO_FRAME_PULSES);
+    view.setUint8(1, device);
+    view.setUint32(2, nextFrameSeq(), true);
+    view.setUint16(6, angleToPulse(xAngle), true);
+    view.setUint16(8, angleToPulse(yAngle), true);
+    return frame;
+}
+
+/**
+ * A move of both gimbal axes as the pose node the ESP32 reads from the RTDB
+ * (ex: laser_servo/pose). Takes its sequence number from the same counter as
+ * the frames; the RTDB stores it as a signed 32-bit integer.
+ *
+ * @param {number} xAngle : x angle, degrees
+ * @param {number} yAngle : y angle, degrees
+ * @returns {{x: number, y: number, seq: number}} the pose
+ */
+export function servoPose(xAngle, yAngle) {
+    return { x: xAngle, y: yAngle, seq: nextFrameSeq() | 0 };
+}
+
+// ============================================================================
+//                               LAN CHANNEL
+// ============================================================================
+export class LanChannel {
+    constructor() {
+        this.socket = null;
+        this.url = null;
+        this.key = null;
+        this.reconnectTimer = null;
+    }
+
+    /**
+     * Follow the ESP32's /lan node. Opens, reopens or closes the connection
+     * when the address or key changes.
+     *
+     * @param {Object|null} info : {ip, port, transport, key} or null
+     */
+    configure(info) {
+        const usable = info && info.transport === "ws" && typeof info.key === "string" && info.key.length === 32;
+        const url = usable ? `ws://${info.ip}:${info.port}` : null;
+        if (url === this.url && usable && info.key === this.keyHex) return;
+
+        this.close();
+        if (!usable) return;
+
+        this.url = url;
+        this.keyHex = info.key;
+        this.key = new Uint8Array(16);
+        for (let i = 0; i < 16; i++) {
+            this.key[i] = parseInt(info.key.substr(2 * i, 2), 16);
+        }
+        this.open();
+    }
+
+    open() {
+        this.reconnectTimer = null;
+        try {
+            this.socket = new WebSocket(this.url);
+        }
+        catch (error) {
+            // Mixed content (ws:// from an https:// page) throws here
+            console.warn("LAN control unavailable:", error.message);
+            this.socket = null;
+            return;
+        }
+        this.socket.binaryType = "arraybuffer";
+        this.socket.onclose = () => {
+            this.socket = null;
+            if (this.url && !this.reconnectTimer) {
+                this.reconnectTimer = setTimeout(() => this.open(), RECONNECT_DELAY_MS);
+            }
+        };
+    }
+
+    close() {
+        this.url = null;
+        this.keyHex = null;
+        clearTimeout(this.reconnectTimer);
+        this.reconnectTimer = null;
+        if (this.socket) {
+            this.socket.onclose = null;
+            this.socket.close();
+            this.socket = null;
+        }
+    }
+
+    get ready() {
+        return this.socket !== null && this.socket.readyState === WebSocket.OPEN;
+    }
+
+    /**
+     * Send a frame, tagged with the session key.
+     *
+     * @param {Uint8Array} frame : from encodeServoFrame()
+     * @returns {boolean} false if the channel is not open; write the RTDB instead
+     */
+    sendFrame(frame) {
+        if (!this.ready) return false;
+
+        const bytes = new Uint8Array(LAN_PACKET_SIZE);
+        bytes.set(frame);
+        new DataView(bytes.buffer).setBigUint64(SERVO_FRAME_SIZE, siphash24(this.key, frame), true);
+
+        this.socket.send(bytes);
+        return true;
+    }
+}
+
+// ============================================================================
+//                               LAN TRANSPORT
+// ============================================================================
+// Write transport (writes.js) for the LAN channel
+export class LanTransport {
+    /**
+     * @param {LanChannel} channel : the open (or not) LAN channel
+     * @param {Object} poseDevices : pose path -> DeviceId (ex: {"laser_servo/pose": 3})
+     * @param {Object} fallback : transport for everything the LAN cannot carry
+     */
+    constructor(channel, poseDevices, fallback) {
+        this.channel = channel;
+        this.poseDevices = poseDevices;
+        this.fallback = fallback;
+    }
+
+    get minIntervalMs() {
+        return this.channel.ready ? LAN_MIN_INTERVAL_MS : this.fallback.minIntervalMs;
+    }
+
+    /**
+     * Send every pose in the batch as a frame. A batch of nothing but moves
+     * ends there. Anything else is a change of the desired state, so the
+     * whole batch, poses included, is written to the fallback as well.
+     *
+     * @param {Object} values : RTDB path -> value
+     * @returns {Promise} settles once the batch is delivered
+     */
+    send(values) {
+        if (!this.channel.ready) return this.fallback.send(values);
+
+        let movesOnly = true;
+        for (const [path, value] of Object.entries(values)) {
+            const device = this.poseDevices[path];
+            const sent = device !== undefined && value !== null &&
+                         this.channel.sendFrame(encodeServoFrame(device, value.x, value.y));
+            if (!sent) movesOnly = false;
+        }
+        return movesOnly ? Promise.resolve() : this.fallback.send(values);
+    }
+}
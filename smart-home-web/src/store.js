@@ -0,0 +1,111 @@
+/**
+ *          Description:        Client-side copy of the selected device's
+ *                              desired state. One onValue() subscription
+ *                              feeds apply() with all of it on every change.
+ *                              Each watcher is registered for one path and
+ *                              only called when the value there differs from
+ *                              the last one it saw, so the DOM is updated for
+ *                              what changed and nothing else. Reads (ex:
+ *                              refreshStatus) come from the copy and cost no
+ *                              round trip.
+ *
+ *          Author:             Eddie Kwak
+ *          Last Modified:      10/16/2026
+ */
+
+// ============================================================================
+//                                 HELPERS
+// ============================================================================
+/**
+ * @param {Object|null} tree : subtree as snapshot.val() returns it
+ * @param {string} path      : relative path (ex: "heating_pad/state")
+ * @returns {*} the value at path, or null if there is none
+ */
+function valueAt(tree, path) {
+    let node = tree;
+    for (const key of path.split("/")) {
+        if (node === null || typeof node !== "object" || !(key in node)) return null;
+        node = node[key];
+    }
+    return node;
+}
+
+function sameValue(a, b) {
+    if (a === b) return true;
+    if (a === null || b === null || typeof a !== "object" || typeof b !== "object") return false;
+    return JSON.stringify(a) === JSON.stringify(b);
+}
+
+// ============================================================================
+//                                STATE STORE
+// ============================================================================
+export class StateStore {
+    constructor() {
+        this.tree = null;
+        this.loaded = false;
+        this.watchers = [];
+    }
+
+    /**
+     * Call render with the value at path now (if the first snapshot is in)
+     * and whenever it changes. Missing values are null.
+     *
+     * @param {string} path       : relative path (ex: "heating_pad/state")
+     * @param {function} render   : called with the new value
+     */
+    watch(path, render) {
+        const watcher = { path, render, value: undefined };
+        this.watchers.push(watcher);
+        if (this.loaded) this.notify(watcher);
+    }
+
+    /**
+     * @param {Object|null} tree : the subtree from the subscription
+     */
+    apply(tree) {
+        this.tree = tree;
+        this.loaded = true;
+        for (const watcher of this.watchers) this.notify(watcher);
+    }
+
+    notify(watcher) {
+        const value = valueAt(this.tree, watcher.path);
+        if (watcher.value !== undefined && sameValue(value, watcher.value)) return;
+        watcher.value = value;
+        watcher.render(value);
+    }
+
+    /**
+     * Forget the copy (ex: another device was selected). Every watcher is
+     * called with null, then again once the next subtree is applied.
+     */
+    reset() {
+        this.tree = null;
+        this.loaded = false;
+        for (const watcher of this.watchers) {
+            watcher.value = undefined;
+            watcher.render(null);
+        }
+    }
+
+    /**
+     * @param {string} path : relative path (ex: "heating_pad/state")
+     * @returns {*} the cached value, null if missing or not loaded yet
+     */
+    get(path) {
+        return valueAt(this.tree, path);
+    }
+
+    /**
+     * The RTDB raises local writes here before the server acknowledges them,
+     * so the copy already includes every write this page has sent.
+     *
+     * @param {Object} values : relative path -> value
+     * @returns {boolean} true if writing values would change the copy, or
+     *                    if it is not loaded yet and cannot tell
+     */
+    wouldChange(values) {
+        if (!this.loaded) return true;
+        return Object.entries(values).some(([path, value]) => !sameValue(valueAt(this.tree, path), value));
+    }
+}
@@ -0,0 +1,146 @@
+/**
+ *          Description:        Batched device writes for the dashboard.
+ *                              Every write goes into one pending batch, keyed
+ *                              by RTDB path, so a value superseded before it
+ *                              is sent is simply replaced. The batch is sent
+ *                              at most once per animation frame, and no sooner
+ *                              than the transport's minimum interval after the
+ *                              last one, as a single call to the transport.
+ *                              A joystick drag therefore costs one write per
+ *                              frame at most, whatever the pointer event rate,
+ *                              and a release replaces the move still pending.
+ *
+ *                              The transport is pluggable: RtdbTransport sends
+ *                              one multi-path update(), LanTransport (lan.js)
+ *                              sends gimbal moves straight to the ESP32 and
+ *                              hands everything else to the RTDB.
+ *
+ *          Author:             Eddie Kwak
+ *          Last Modified:      10/16/2026
+ */
+
+// ============================================================================
+//                                  IMPORTS
+// ============================================================================
+import {
+    ref,
+    update,
+    increment,
+} from "https://www.gstatic.com/firebasejs/10.12.2/firebase-database.js";
+
+// ============================================================================
+//                              CONFIGURATION
+// ============================================================================
+// Minimum time between RTDB updates, so a drag costs at most 20 writes/s
+const RTDB_MIN_INTERVAL_MS = 50;
+
+// ============================================================================
+//                               RTDB TRANSPORT
+// ============================================================================
+export class RtdbTransport {
+    /**
+     * @param {Object} database     : from getDatabase()
+     * @param {StateStore} desired  : local copy of the desired state at root
+     */
+    constructor(database, desired) {
+        this.database = database;
+        this.desired = desired;
+        this.root = null;
+        this.minIntervalMs = RTDB_MIN_INTERVAL_MS;
+    }
+
+    /**
+     * Write a batch as one multi-path update under the selected device's
+     * desired state that also bumps its version. The ESP32 reports the
+     * version it has converged on under reported/version, beside it. A batch
+     * that leaves the desired state as it is (ex: a switch clicked twice
+     * within a frame) is not sent, so the version only counts real changes
+     * and the ESP32 never sees one it has nothing to converge on.
+     *
+     * @param {Object} values : path under the root -> value
+     * @returns {Promise} settles when the RTDB acknowledges the update
+     */
+    send(values) {
+        if (!this.root) return Promise.reject(new Error("No device selected"));
+        if (!this.desired.wouldChange(values)) return Promise.resolve();
+        return update(ref(this.database, this.root), { ...values, version: increment(1) });
+    }
+}
+
+// ============================================================================
+//                                WRITE BATCHER
+// ============================================================================
+export class WriteBatcher {
+    /**
+     * @param {Object} transport : {minIntervalMs, send(values) -> Promise}
+     */
+    constructor(transport) {
+        this.transport = transport;
+        this.pending = new Map();
+        this.waiters = [];
+        this.frameRequested = false;
+        this.lastSendTime = -Infinity;
+    }
+
+    /**
+     * Add values to the pending batch, replacing any pending value at the
+     * same path.
+     *
+     * @param {Object} values : RTDB path -> value (ex: {"heating_pad/state": 1})
+     * @returns {Promise} settles when the batch carrying these values is sent
+     */
+    write(values) {
+        for (const [path, value] of Object.entries(values)) {
+            this.pending.set(path, value);
+        }
+
+        const sent = new Promise((resolve, reject) => this.waiters.push({ resolve, reject }));
+        this.requestFrame();
+        return sent;
+    }
+
+    requestFrame() {
+        if (this.frameRequested) return;
+        this.frameRequested = true;
+        requestAnimationFrame((now) => this.onFrame(now));
+    }
+
+    onFrame(now) {
+        this.frameRequested = false;
+        if (this.pending.size === 0) return;
+
+        if (now - this.lastSendTime < this.transport.minIntervalMs) {
+            this.requestFrame();
+            return;
+        }
+        this.flush(now);
+    }
+
+    /**
+     * Send the pending batch now. Animation frames stop while the page is
+     * hidden, so call this when it is hidden.
+     *
+     * @param {number} now : time on the performance.now() clock
+     */
+    flush(now = performance.now()) {
+        if (this.pending.size === 0) return;
+
+        const values = Object.fromEntries(this.pending);
+        const waiters = this.waiters;
+        this.pending = new Map();
+        this.waiters = [];
+        this.lastSendTime = now;
+
+        let sent;
+        try {
+            sent = Promise.resolve(this.transport.send(values));
+        }
+        catch (error) {
+            sent = Promise.reject(error);
+        }
+        sent.then(
+            () => waiters.forEach((waiter) => waiter.resolve()),
+            (error) => waiters.forEach((waiter) => waiter.reject(error))
+        );
+    }
+}
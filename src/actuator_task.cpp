@@ -0,0 +1,54 @@
+/**
+ * Description:     Command consumer driving the actuators
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <atomic>
+#include "actuator_task.h"
+#include "actuators.h"
+#include "instrumentation.h"
+#include "hal/hal.h"
+
+static CommandRing command_ring;
+static std::atomic<HalTask> actuator_task_handle(NULL);
+
+// Commands pushed and fully applied. The ring alone cannot tell whether the
+// command popped last has been applied yet.
+static std::atomic<uint32_t> submitted_count(0);
+static std::atomic<uint32_t> applied_count(0);
+
+bool actuator_task_submit(const Command& command) {
+  if (!command_ring.push(command)) return false;
+  submitted_count.fetch_add(1);
+  HalTask consumer = actuator_task_handle.load();
+  if (consumer != NULL) hal_task_notify(consumer);
+  return true;
+}
+
+bool actuator_task_idle(void) {
+  return applied_count.load() == submitted_count.load() && actuators_settled();
+}
+
+void actuator_task(void* pvParameters) {
+  (void)pvParameters;
+  actuator_task_handle.store(hal_task_current());
+  Command command;
+
+  for (;;) {
+    // One notification may cover several pushes, so drain the whole ring.
+    // Draining before the first wait also picks up anything pushed before
+    // the handle above was published.
+    while (command_ring.pop(command)) {
+      INSTRUMENT_RECORD_NS(STAGE_QUEUE_WAIT, (hal_micros() - command.timestamp_us) * 1000);
+      INSTRUMENT_BEGIN(apply);
+      actuators_apply(command);
+      INSTRUMENT_END(STAGE_APPLY, apply);
+      applied_count.fetch_add(1);
+    }
+
+    // Blocks without consuming CPU until the network task submits a command
+    hal_task_wait_notify();
+  }
+}
@@ -0,0 +1,36 @@
+/**
+ * Description:     Actuator side of the firmware. Sleeps until a command
+ *                  arrives and applies it to the GPIO/servo outputs.
+ *
+ *                  Commands travel through a lock-free SPSC ring: the network
+ *                  task is the only producer (actuator_task_submit) and the
+ *                  actuator task the only consumer. A task notification wakes
+ *                  the consumer, so neither side ever blocks the other.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef ACTUATOR_TASK_H
+#define ACTUATOR_TASK_H
+
+#include "command.h"
+#include "spsc_ring.h"
+
+// Commands buffered between the network and actuator tasks
+const uint32_t COMMAND_RING_CAPACITY = 64;
+
+typedef SpscRing<Command, COMMAND_RING_CAPACITY> CommandRing;
+
+// Queue a command for actuation and wake the actuator task. Must only be
+// called from the single producer task. Returns false if the ring is full.
+bool actuator_task_submit(const Command& command);
+
+// True once every submitted command has been applied and the servos have
+// reached their targets. Safe from any task.
+bool actuator_task_idle(void);
+
+// FreeRTOS task body. pvParameters is unused.
+void actuator_task(void* pvParameters);
+
+#endif
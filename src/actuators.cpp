@@ -0,0 +1,333 @@
+/**
+ * Description:     GPIO and servo actuation
+ *
+ *                  Every output is a row of the device table (device_table.h).
+ *                  On/off outputs are written as soon as their command is
+ *                  applied. The heating pad is driven by the thermostat,
+ *                  which takes its master switch and setpoint from here.
+ *                  Servo commands only move the motion planner's target (both
+ *                  targets at once for a pose, so the two axes start in the
+ *                  same period and arrive together); a periodic timer steps
+ *                  the planner at a fixed rate and writes the interpolated
+ *                  angles, independent of how often or how irregularly
+ *                  commands arrive. Pose targets are in tenths of a degree,
+ *                  so a servo frame's pulse widths are not rounded away.
+ *                  Angles are converted to pulse widths in microseconds, so
+ *                  servos move in sub-degree steps, and all four channels
+ *                  are handed to the PWM driver in one call.
+ *
+ *                  The last commanded state is kept in storage and restored
+ *                  by actuators_init(), so after a reboot the heating pad and
+ *                  servos go straight back to where the user left them instead
+ *                  of waiting for the network. Writes are deferred until the
+ *                  state settles and rate limited to spare the flash.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <math.h>
+#include <string.h>
+#include "actuators.h"
+#include "device_table.h"
+#include "motion_planner.h"
+#include "servo_frame.h"
+#include "thermostat.h"
+#include "instrumentation.h"
+#include "logger.h"
+#include "hal/hal.h"
+
+// ============================================================================
+//                         MOTION PLANNER CONFIGURATION
+// ============================================================================
+// Rate the servo trajectories are stepped at
+const uint32_t MOTION_STEP_RATE_HZ = 200;
+const uint32_t MOTION_STEP_PERIOD_US = 1000000 / MOTION_STEP_RATE_HZ;
+
+// Speed limits per ServoAxis; the angle range comes from the device table.
+// Camera gimbal moves gently, the laser is allowed to be quicker. Pulse
+// widths for 0 and 180 degrees are in servo_frame.h, shared with the frames.
+
+struct AxisSpeed {
+  float max_velocity;       // degrees/s
+  float max_acceleration;   // degrees/s^2
+};
+
+static const AxisSpeed AXIS_SPEEDS[AXIS_COUNT] = {
+  { 180.0f, 720.0f },       // AXIS_CAMERA_X
+  { 180.0f, 720.0f },       // AXIS_CAMERA_Y
+  { 360.0f, 2000.0f },      // AXIS_LASER_X
+  { 360.0f, 2000.0f },      // AXIS_LASER_Y
+};
+
+
+// ============================================================================
+//                          PERSISTENCE CONFIGURATION
+// ============================================================================
+#define ACTUATOR_STATE_KEY "actuators"
+
+// Bump when ActuatorSnapshot changes, so an old blob is ignored
+const uint8_t ACTUATOR_SNAPSHOT_VERSION = 2;
+
+// State must be unchanged this long before it is written, so a burst of
+// servo commands costs one write
+const uint32_t STATE_SAVE_SETTLE_MS = 2000;
+
+// Never write more often than this...
+const uint32_t STATE_SAVE_MIN_INTERVAL_MS = 30000;
+
+// ...but don't hold a change back longer than this while it keeps changing
+const uint32_t STATE_SAVE_MAX_DELAY_MS = 120000;
+
+
+// ============================================================================
+//                         STATE TRACKING VARIABLES
+// ============================================================================
+// Last value commanded on each device table row
+static int16_t channel_values[DEVICE_CHANNEL_COUNT];
+
+// Rows feeding the thermostat
+constexpr uint8_t HEATER_ROW = device_row_of_kind(DEVICE_KIND_HEATER);
+constexpr uint8_t SETPOINT_ROW = device_row_of_kind(DEVICE_KIND_SETPOINT);
+static_assert(HEATER_ROW != DEVICE_NO_ROW && SETPOINT_ROW != DEVICE_NO_ROW, "The thermostat needs a heater and a setpoint row");
+
+// Everything needed to put the outputs back after a reboot. A different
+// version or table size makes an old blob unreadable, so it is ignored.
+struct ActuatorSnapshot {
+  uint8_t version;
+  uint8_t reserved;
+  int16_t values[DEVICE_CHANNEL_COUNT];
+};
+
+// Latest state (written by the actuator task) and the copy in storage (owned
+// by whichever task calls actuators_persist())
+static ActuatorSnapshot current_snapshot;
+static ActuatorSnapshot saved_snapshot;
+static uint32_t first_change_ms = 0;
+static uint32_t last_change_ms = 0;
+static bool snapshot_dirty = false;
+static uint32_t last_save_ms = 0;
+static bool saved_once = false;
+static HalSpinlock snapshot_lock = HAL_SPINLOCK_INIT;
+
+
+// ============================================================================
+//                    CAMERA (SERVO) ORIENTATION VARIABLES
+// ============================================================================
+static_assert(AXIS_COUNT == HAL_SERVO_CHANNELS, "Each ServoAxis is driven by the HAL servo channel of the same index");
+
+// Last pulse width written to each servo, indexed by ServoAxis, so nothing
+// is written while every axis is at rest
+static uint16_t servo_pulses[AXIS_COUNT];
+
+static MotionPlanner motion_planner;
+
+// Guards motion_planner between the actuator task and the step timer
+static HalSpinlock motion_planner_lock = HAL_SPINLOCK_INIT;
+
+
+static uint16_t angle_to_pulse_us(float angle) {
+  if (angle < 0.0f) angle = 0.0f;
+  if (angle > 180.0f) angle = 180.0f;
+  return SERVO_MIN_PULSE_US + (uint16_t)lroundf(angle * (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) / 180.0f);
+}
+
+// Steps every trajectory by one period and, if any axis moved, writes all of
+// them in one call
+static void motion_step(void* arg) {
+  (void)arg;
+  INSTRUMENT_BEGIN(motion_step);
+  uint16_t pulses[AXIS_COUNT];
+
+  hal_spin_lock(&motion_planner_lock);
+  motion_planner.step(MOTION_STEP_PERIOD_US / 1000000.0f);
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) pulses[i] = angle_to_pulse_us(motion_planner.position(i));
+  hal_spin_unlock(&motion_planner_lock);
+
+  if (memcmp(pulses, servo_pulses, sizeof(pulses)) != 0) {
+    memcpy(servo_pulses, pulses, sizeof(pulses));
+    hal_servo_write_all(servo_pulses);
+  }
+  INSTRUMENT_END(STAGE_MOTION_STEP, motion_step);
+}
+
+static void set_servo_target(uint8_t axis, int16_t angle) {
+  hal_spin_lock(&motion_planner_lock);
+  motion_planner.set_target(axis, angle);
+  hal_spin_unlock(&motion_planner_lock);
+}
+
+// Both axes of a gimbal under one lock, so no step sees only one of them
+static void set_servo_targets(uint8_t x_axis, float x_angle, uint8_t y_axis, float y_angle) {
+  hal_spin_lock(&motion_planner_lock);
+  motion_planner.set_targets(x_axis, x_angle, y_axis, y_angle);
+  hal_spin_unlock(&motion_planner_lock);
+}
+
+void actuators_values(int16_t* values) {
+  hal_spin_lock(&snapshot_lock);
+  memcpy(values, current_snapshot.values, sizeof(current_snapshot.values));
+  hal_spin_unlock(&snapshot_lock);
+}
+
+int16_t actuators_servo_angle(uint8_t axis) {
+  if (axis >= AXIS_COUNT) return 0;
+  hal_spin_lock(&motion_planner_lock);
+  float angle = motion_planner.position(axis);
+  hal_spin_unlock(&motion_planner_lock);
+  return (int16_t)lroundf(angle);
+}
+
+bool actuators_settled(void) {
+  bool moving = false;
+  hal_spin_lock(&motion_planner_lock);
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) moving = moving || motion_planner.moving(i);
+  hal_spin_unlock(&motion_planner_lock);
+  return !moving;
+}
+
+// Copies the current outputs into current_snapshot and marks it for saving
+// if anything changed
+static void update_snapshot(void) {
+  ActuatorSnapshot snapshot = current_snapshot;
+  memcpy(snapshot.values, channel_values, sizeof(snapshot.values));
+
+  uint32_t now = hal_millis();
+  hal_spin_lock(&snapshot_lock);
+  if (memcmp(&snapshot, &current_snapshot, sizeof(snapshot)) != 0) {
+    current_snapshot = snapshot;
+    if (!snapshot_dirty) first_change_ms = now;
+    last_change_ms = now;
+    snapshot_dirty = true;
+  }
+  hal_spin_unlock(&snapshot_lock);
+}
+
+// Loads the stored state into channel_values. Anything missing, or saved by
+// firmware with a different device table, falls back to the table defaults.
+static void restore_snapshot(void) {
+  for (uint8_t row = 0; row < DEVICE_CHANNEL_COUNT; row++) channel_values[row] = DEVICE_TABLE[row].default_value;
+
+  ActuatorSnapshot stored;
+  if (hal_storage_read(ACTUATOR_STATE_KEY, &stored, sizeof(stored)) &&
+      stored.version == ACTUATOR_SNAPSHOT_VERSION) {
+    for (uint8_t row = 0; row < DEVICE_CHANNEL_COUNT; row++) {
+      const DeviceChannel& entry = DEVICE_TABLE[row];
+      int16_t value = stored.values[row];
+      channel_values[row] = value < entry.min_value ? entry.min_value : value > entry.max_value ? entry.max_value : value;
+    }
+    LOGGER_INFO("Restored last actuator state");
+  }
+
+  memset(&current_snapshot, 0, sizeof(current_snapshot));
+  current_snapshot.version = ACTUATOR_SNAPSHOT_VERSION;
+  memcpy(current_snapshot.values, channel_values, sizeof(current_snapshot.values));
+  saved_snapshot = current_snapshot;
+}
+
+void actuators_init(void) {
+  restore_snapshot();
+
+  // Every output starts at its last known state, or its default
+  for (uint8_t row = 0; row < DEVICE_CHANNEL_COUNT; row++) {
+    const DeviceChannel& entry = DEVICE_TABLE[row];
+    switch (entry.kind) {
+      case DEVICE_KIND_SWITCH:
+        hal_gpio_output(entry.pin);
+        hal_gpio_write(entry.pin, channel_values[row] == 1);
+        break;
+
+      case DEVICE_KIND_HEATER:
+      case DEVICE_KIND_SETPOINT:
+        break;
+
+      case DEVICE_KIND_SERVO: {
+        AxisLimits limits = { (float)entry.min_value, (float)entry.max_value,
+                              AXIS_SPEEDS[entry.axis].max_velocity, AXIS_SPEEDS[entry.axis].max_acceleration };
+        motion_planner.configure(entry.axis, limits, channel_values[row]);
+        servo_pulses[entry.axis] = angle_to_pulse_us(channel_values[row]);
+        hal_servo_attach(entry.axis, entry.pin);
+        break;
+      }
+    }
+  }
+  hal_servo_write_all(servo_pulses);
+
+  const DeviceChannel& heater = DEVICE_TABLE[HEATER_ROW];
+  const DeviceChannel& setpoint = DEVICE_TABLE[SETPOINT_ROW];
+  thermostat_begin(heater.pin, setpoint.pin, channel_values[HEATER_ROW] == 1, channel_values[SETPOINT_ROW]);
+
+  // Fixed-rate trajectory stepping
+  if (!hal_timer_start_periodic(motion_step, NULL, MOTION_STEP_PERIOD_US)) {
+    LOGGER_ERROR("Failed to start motion timer");
+  }
+}
+
+static void apply_pose(const Command& command) {
+  uint8_t x_row = device_row_for_command(command.device, CHANNEL_X);
+  uint8_t y_row = device_row_for_command(command.device, CHANNEL_Y);
+  if (x_row == DEVICE_NO_ROW || y_row == DEVICE_NO_ROW) return;
+  if (DEVICE_TABLE[x_row].kind != DEVICE_KIND_SERVO || DEVICE_TABLE[y_row].kind != DEVICE_KIND_SERVO) return;
+
+  // The planner gets the tenths; the stored and reported values stay whole
+  // degrees like every other channel's
+  channel_values[x_row] = pose_whole_degrees(pose_x(command.value));
+  channel_values[y_row] = pose_whole_degrees(pose_y(command.value));
+  set_servo_targets(DEVICE_TABLE[x_row].axis, (float)pose_x(command.value) / POSE_UNITS_PER_DEGREE,
+                    DEVICE_TABLE[y_row].axis, (float)pose_y(command.value) / POSE_UNITS_PER_DEGREE);
+  update_snapshot();
+}
+
+void actuators_apply(const Command& command) {
+  if (command.channel == CHANNEL_POSE) {
+    apply_pose(command);
+    return;
+  }
+
+  uint8_t row = device_row_for_command(command.device, command.channel);
+  if (row == DEVICE_NO_ROW) return;
+
+  const DeviceChannel& entry = DEVICE_TABLE[row];
+  channel_values[row] = (int16_t)command.value;
+  switch (entry.kind) {
+    case DEVICE_KIND_SWITCH:
+      hal_gpio_write(entry.pin, command.value == 1);
+      break;
+
+    case DEVICE_KIND_SERVO:
+      set_servo_target(entry.axis, command.value);
+      break;
+
+    case DEVICE_KIND_HEATER:
+      thermostat_set_enabled(command.value == 1);
+      break;
+
+    case DEVICE_KIND_SETPOINT:
+      thermostat_set_setpoint(command.value);
+      break;
+  }
+  update_snapshot();
+}
+
+void actuators_persist(uint32_t now_ms) {
+  ActuatorSnapshot snapshot;
+
+  hal_spin_lock(&snapshot_lock);
+  bool settled = now_ms - last_change_ms >= STATE_SAVE_SETTLE_MS || now_ms - first_change_ms >= STATE_SAVE_MAX_DELAY_MS;
+  bool rate_ok = !saved_once || now_ms - last_save_ms >= STATE_SAVE_MIN_INTERVAL_MS;
+  bool due = snapshot_dirty && settled && rate_ok;
+  if (due) {
+    snapshot = current_snapshot;
+    snapshot_dirty = false;
+  }
+  hal_spin_unlock(&snapshot_lock);
+  if (!due) return;
+
+  // Changed and changed back (ex: the stream snapshot right after a reboot)
+  if (memcmp(&snapshot, &saved_snapshot, sizeof(snapshot)) == 0) return;
+
+  last_save_ms = now_ms;
+  saved_once = true;
+  if (hal_storage_write(ACTUATOR_STATE_KEY, &snapshot, sizeof(snapshot))) saved_snapshot = snapshot;
+  else LOGGER_ERROR("Failed to save actuator state");
+}
@@ -0,0 +1,37 @@
+/**
+ * Description:     Owns the GPIO outputs and servos and applies decoded
+ *                  commands to them. Only the actuator task should call
+ *                  actuators_apply() once the tasks are running.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef ACTUATORS_H
+#define ACTUATORS_H
+
+#include "command.h"
+
+// Configure pins, attach servos and move everything to its last stored
+// state (or its default position on first boot)
+void actuators_init(void);
+
+// Clamp and apply a single command to its device (both axes for a pose)
+void actuators_apply(const Command& command);
+
+// Copy the value last applied on every device table row (DEVICE_CHANNEL_COUNT
+// entries, in table order). Safe from any task.
+void actuators_values(int16_t* values);
+
+// Current position of a servo axis (ServoAxis) in whole degrees, which lags
+// its commanded angle while the axis is moving
+int16_t actuators_servo_angle(uint8_t axis);
+
+// True once every servo axis has reached its target. Safe from any task.
+bool actuators_settled(void);
+
+// Write the current state to storage if it changed and has settled. Cheap
+// to call often; call it from one task only.
+void actuators_persist(uint32_t now_ms);
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * Description:     DMA frame consumer and per-input decimation filters
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include "analog_input.h"
+#include "filters.h"
+#include "logger.h"
+#include "hal/hal.h"
+
+// Block means considered by the spike-rejecting median
+const uint8_t ANALOG_MEDIAN_WINDOW = 5;
+
+// A reading older than this many output periods is stale
+const uint32_t ANALOG_STALE_PERIODS = 3;
+
+// Longest wait for a frame before checking in again
+const uint32_t ANALOG_READ_TIMEOUT_MS = 100;
+
+struct AnalogInput {
+  BlockAverage block;
+  MedianFilter<ANALOG_MEDIAN_WINDOW> median;
+  FirDecimator<FIR_BINOMIAL_TAPS> fir;
+
+  // Published reading, guarded by reading_lock
+  uint32_t mv;
+  uint32_t updated_ms;
+  bool valid;
+};
+
+static uint8_t input_pins[HAL_ADC_MAX_INPUTS];
+static AnalogInput inputs[HAL_ADC_MAX_INPUTS];
+static uint8_t input_count = 0;
+static uint32_t stale_ms = 0;
+static bool sampling = false;
+static HalSpinlock reading_lock = HAL_SPINLOCK_INIT;
+
+// Only the analog task touches the frame, so it need not live on its stack
+static HalAdcSample frame[ANALOG_FRAME_SAMPLES];
+
+uint8_t analog_input_add(uint8_t pin) {
+  if (sampling || input_count >= HAL_ADC_MAX_INPUTS) return ANALOG_NO_INPUT;
+  input_pins[input_count] = pin;
+  return input_count++;
+}
+
+bool analog_input_begin(uint32_t output_rate_hz) {
+  if (input_count == 0) return false;
+
+  uint32_t frame_rate_hz = ANALOG_SAMPLE_RATE_HZ / ANALOG_FRAME_SAMPLES;
+  uint32_t factor = output_rate_hz > 0 ? (frame_rate_hz + output_rate_hz / 2) / output_rate_hz : 1;
+  if (factor == 0) factor = 1;
+  for (uint8_t i = 0; i < input_count; i++) inputs[i].fir.begin(FIR_BINOMIAL_Q15, factor);
+  stale_ms = ANALOG_STALE_PERIODS * factor * 1000 / frame_rate_hz;
+
+  sampling = hal_adc_continuous_begin(input_pins, input_count, ANALOG_SAMPLE_RATE_HZ, ANALOG_FRAME_SAMPLES);
+  if (!sampling) LOGGER_ERROR("Failed to start continuous ADC");
+  return sampling;
+}
+
+bool analog_input_read_mv(uint8_t input, uint32_t& mv) {
+  if (input >= input_count) return false;
+
+  hal_spin_lock(&reading_lock);
+  bool valid = inputs[input].valid;
+  uint32_t updated_ms = inputs[input].updated_ms;
+  mv = inputs[input].mv;
+  hal_spin_unlock(&reading_lock);
+
+  return valid && hal_millis() - updated_ms <= stale_ms;
+}
+
+// Runs one frame's worth of conversions through every input's filters
+static void process_frame(size_t count) {
+  for (size_t i = 0; i < count; i++) inputs[frame[i].input].block.add(frame[i].raw);
+
+  for (uint8_t i = 0; i < input_count; i++) {
+    AnalogInput& input = inputs[i];
+    int32_t mean;
+    int32_t output;
+    if (!input.block.take(mean)) continue;
+    if (!input.fir.push(input.median.push(mean), output)) continue;
+
+    uint32_t mv = hal_adc_raw_to_mv((uint16_t)filter_to_integer(output));
+    hal_spin_lock(&reading_lock);
+    input.mv = mv;
+    input.updated_ms = hal_millis();
+    input.valid = true;
+    hal_spin_unlock(&reading_lock);
+  }
+}
+
+void analog_task(void* pvParameters) {
+  (void)pvParameters;
+
+  for (;;) {
+    // Blocks until the DMA ring has a full frame
+    size_t count = hal_adc_continuous_read(frame, ANALOG_FRAME_SAMPLES, ANALOG_READ_TIMEOUT_MS);
+    if (count > 0) process_frame(count);
+  }
+}
@@ -0,0 +1,52 @@
+/**
+ * Description:     Continuously sampled, filtered analog inputs.
+ *
+ *                  The ADC converts every registered pin in turn by DMA
+ *                  (hal_adc_continuous_*). The analog task sleeps until a
+ *                  frame is ready, then runs each input through the
+ *                  decimation chain in filters.h (frame average, median,
+ *                  FIR) and publishes one reading per output period. No
+ *                  task ever waits on a conversion, and consumers only read
+ *                  the latest filtered value.
+ *
+ *                  TO ADD A NEW ANALOG SENSOR: call analog_input_add() with
+ *                  its pin during setup, before analog_input_begin(), and
+ *                  read it back with analog_input_read_mv().
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef ANALOG_INPUT_H
+#define ANALOG_INPUT_H
+
+#include <stdint.h>
+
+// All inputs together; the lowest rate the ESP32's DMA mode supports
+const uint32_t ANALOG_SAMPLE_RATE_HZ = 20000;
+
+// Conversions per DMA frame (80 frames/s at the rate above)
+const uint16_t ANALOG_FRAME_SAMPLES = 250;
+
+// Filtered readings per second per input
+const uint32_t ANALOG_OUTPUT_RATE_HZ = 10;
+
+// analog_input_add() when no input is free
+const uint8_t ANALOG_NO_INPUT = 0xFF;
+
+// Register pin for sampling. Setup code only, before analog_input_begin().
+// Returns the input index to read it with.
+uint8_t analog_input_add(uint8_t pin);
+
+// Start conversion. Readings come out at output_rate_hz, rounded to a whole
+// number of frames. Returns false if nothing was added or the ADC failed.
+bool analog_input_begin(uint32_t output_rate_hz);
+
+// Latest filtered reading of an input in millivolts. Returns false before the
+// first reading or when sampling has stalled.
+bool analog_input_read_mv(uint8_t input, uint32_t& mv);
+
+// FreeRTOS task body running the filters. pvParameters is unused.
+void analog_task(void* pvParameters);
+
+#endif
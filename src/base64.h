@@ -0,0 +1,86 @@
+/**
+ * Description:     Base64 (RFC 4648, padded) into and out of caller buffers.
+ *
+ *                  No allocation, so binary frames can travel through the
+ *                  RTDB as strings and be decoded on the stream path.
+ *
+ *                  Header-only so the host tools can share it.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef BASE64_H
+#define BASE64_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Text length for size bytes, without the terminator
+constexpr size_t base64_encoded_size(size_t size) {
+  return (size + 2) / 3 * 4;
+}
+
+inline char base64_digit(uint8_t value) {
+  return "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[value & 0x3F];
+}
+
+// -1 for anything that is not a base64 digit
+inline int base64_value(char digit) {
+  if (digit >= 'A' && digit <= 'Z') return digit - 'A';
+  if (digit >= 'a' && digit <= 'z') return digit - 'a' + 26;
+  if (digit >= '0' && digit <= '9') return digit - '0' + 52;
+  if (digit == '+') return 62;
+  if (digit == '/') return 63;
+  return -1;
+}
+
+// Writes base64_encoded_size(size) characters and a terminator
+inline void base64_encode(const uint8_t* data, size_t size, char* text) {
+  for (size_t i = 0; i < size; i += 3) {
+    uint32_t group = (uint32_t)data[i] << 16;
+    if (i + 1 < size) group |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < size) group |= data[i + 2];
+
+    *text++ = base64_digit((uint8_t)(group >> 18));
+    *text++ = base64_digit((uint8_t)(group >> 12));
+    *text++ = i + 1 < size ? base64_digit((uint8_t)(group >> 6)) : '=';
+    *text++ = i + 2 < size ? base64_digit((uint8_t)group) : '=';
+  }
+  *text = '\0';
+}
+
+// Decodes text (NUL-terminated) into data. Returns the number of bytes, or 0
+// if text is malformed or decodes to more than capacity.
+inline size_t base64_decode(const char* text, uint8_t* data, size_t capacity) {
+  size_t size = 0;
+  while (*text != '\0') {
+    int digits[4];
+    uint8_t padding = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+      char c = text[i];
+      if (c == '\0') return 0;
+      if (c == '=' && i >= 2) {
+        padding++;
+        digits[i] = 0;
+        continue;
+      }
+      // Nothing but padding may follow padding
+      if (padding > 0) return 0;
+      digits[i] = base64_value(c);
+      if (digits[i] < 0) return 0;
+    }
+    text += 4;
+    if (padding > 0 && *text != '\0') return 0;
+
+    uint32_t group = (uint32_t)digits[0] << 18 | (uint32_t)digits[1] << 12 | (uint32_t)digits[2] << 6 | digits[3];
+    uint8_t bytes = 3 - padding;
+    if (size + bytes > capacity) return 0;
+    data[size++] = (uint8_t)(group >> 16);
+    if (bytes > 1) data[size++] = (uint8_t)(group >> 8);
+    if (bytes > 2) data[size++] = (uint8_t)group;
+  }
+  return size;
+}
+
+#endif
@@ -0,0 +1,21 @@
+/**
+ * Description:     Data cache line size of the target, so fields written by
+ *                  different cores can be placed on lines of their own (ex:
+ *                  the indices of the lock-free rings).
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/16/2026
+ */
+
+#ifndef CACHE_LINE_H
+#define CACHE_LINE_H
+
+#include <stddef.h>
+
+#ifdef ARDUINO
+constexpr size_t CACHE_LINE_SIZE = 32;   // ESP32
+#else
+constexpr size_t CACHE_LINE_SIZE = 64;   // x86-64 and most ARM hosts
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * Description:     Decoded actuator command passed from the network task to
+ *                  the actuator task.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stdint.h>
+
+// Devices that can be addressed by a command
+enum DeviceId : uint8_t {
+  DEVICE_HEATING_PAD = 0,
+  DEVICE_TEMPERATURE_SENSOR,
+  DEVICE_CAMERA,
+  DEVICE_LASER,
+  DEVICE_COUNT
+};
+
+// Channels within a device. On/off devices use CHANNEL_STATE, servo
+// gimbals use CHANNEL_X (left/right) and CHANNEL_Y (up/down), and the
+// heating pad takes its thermostat setpoint on CHANNEL_SETPOINT.
+const uint8_t CHANNEL_STATE = 0;
+const uint8_t CHANNEL_X = 0;
+const uint8_t CHANNEL_Y = 1;
+const uint8_t CHANNEL_SETPOINT = 1;
+
+// Highest channel index used by any device, plus one
+const uint8_t CHANNELS_PER_DEVICE = 2;
+
+// Both axes of a gimbal in one command, so they are applied together. Not a
+// table channel: the value packs the X angle in its low half and the Y angle
+// in its high half (see pose_value()), each in tenths of a degree. A servo
+// frame's pulse widths are about 10 us per degree, so tenths carry them to
+// the motion planner without rounding to whole degrees.
+const uint8_t CHANNEL_POSE = CHANNELS_PER_DEVICE;
+
+const int16_t POSE_UNITS_PER_DEGREE = 10;
+
+inline int32_t pose_value(int16_t x_tenths, int16_t y_tenths) {
+  return (int32_t)((uint16_t)x_tenths | ((uint32_t)(uint16_t)y_tenths << 16));
+}
+
+inline int16_t pose_x(int32_t value) { return (int16_t)value; }
+inline int16_t pose_y(int32_t value) { return (int16_t)((uint32_t)value >> 16); }
+
+// Nearest whole degree of a (non-negative) pose angle
+inline int16_t pose_whole_degrees(int16_t tenths) {
+  return (int16_t)((tenths + POSE_UNITS_PER_DEGREE / 2) / POSE_UNITS_PER_DEGREE);
+}
+
+// Compact 12 byte record so the command ring stays small and copies are
+// cheap. value is 32 bits wide only so a pose fits.
+struct Command {
+  uint8_t device;
+  uint8_t channel;
+  int32_t value;
+  uint32_t timestamp_us;  // micros() when the command was decoded
+};
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * Description:     Latest-value-wins coalescing of decoded commands.
+ *
+ *                  A joystick drag produces hundreds of angle events, and only
+ *                  the newest target per axis matters by the time the servo
+ *                  can act on it. Commands are collected per (device, channel)
+ *                  slot; a newer command overwrites an older pending one and
+ *                  the overwrite is counted as dropped.
+ *
+ *                  A pose (CHANNEL_POSE) takes its gimbal's X slot and
+ *                  supersedes both axes. A single axis staged while a pose is
+ *                  pending is folded into the pose instead, so the newest
+ *                  value still wins per axis and both axes still move
+ *                  together.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef COMMAND_COALESCER_H
+#define COMMAND_COALESCER_H
+
+#include "command.h"
+
+class CommandCoalescer {
+public:
+  CommandCoalescer() : pending_mask(0), pending_count(0), dropped_count(0) {}
+
+  // Stage a command, replacing any pending one for the same device channel
+  void add(const Command& command) {
+    if (command.device >= DEVICE_COUNT) return;
+    if (command.channel == CHANNEL_POSE) {
+      add_pose(command);
+      return;
+    }
+    if (command.channel >= CHANNELS_PER_DEVICE) return;
+
+    // Only gimbals are sent poses, so X and Y here are a gimbal's axes
+    uint8_t pose_slot = command.device * CHANNELS_PER_DEVICE + CHANNEL_X;
+    if (is_pending(pose_slot) && slots[pose_slot].channel == CHANNEL_POSE) {
+      Command& pose = slots[pose_slot];
+      int16_t tenths = (int16_t)(command.value * POSE_UNITS_PER_DEGREE);
+      int16_t x_tenths = command.channel == CHANNEL_X ? tenths : pose_x(pose.value);
+      int16_t y_tenths = command.channel == CHANNEL_Y ? tenths : pose_y(pose.value);
+      pose.value = pose_value(x_tenths, y_tenths);
+      pose.timestamp_us = command.timestamp_us;
+      dropped_count++;
+      return;
+    }
+
+    uint8_t slot = command.device * CHANNELS_PER_DEVICE + command.channel;
+    if (is_pending(slot)) dropped_count++;
+    else pending_count++;
+    pending_mask |= (uint16_t)(1u << slot);
+    slots[slot] = command;
+  }
+
+  // Hand every pending command to emit (in device order) and clear them.
+  // Returns the number of commands emitted.
+  template <typename Emit>
+  uint8_t flush(Emit emit) {
+    uint8_t emitted = 0;
+    for (uint8_t slot = 0; pending_mask != 0; slot++) {
+      uint16_t bit = (uint16_t)(1u << slot);
+      if (!(pending_mask & bit)) continue;
+      pending_mask &= (uint16_t)~bit;
+      emit(slots[slot]);
+      emitted++;
+    }
+    pending_count = 0;
+    return emitted;
+  }
+
+  uint8_t pending(void) const { return pending_count; }
+
+  // Total commands superseded before they were flushed
+  uint32_t dropped(void) const { return dropped_count; }
+
+private:
+  static const uint8_t SLOT_COUNT = DEVICE_COUNT * CHANNELS_PER_DEVICE;
+  static_assert(SLOT_COUNT <= 16, "pending_mask is too narrow for the device table");
+
+  bool is_pending(uint8_t slot) const { return (pending_mask & (1u << slot)) != 0; }
+
+  void clear(uint8_t slot) {
+    if (!is_pending(slot)) return;
+    pending_mask &= (uint16_t)~(1u << slot);
+    pending_count--;
+    dropped_count++;
+  }
+
+  void add_pose(const Command& command) {
+    uint8_t x_slot = command.device * CHANNELS_PER_DEVICE + CHANNEL_X;
+    clear(x_slot);
+    clear(command.device * CHANNELS_PER_DEVICE + CHANNEL_Y);
+    pending_mask |= (uint16_t)(1u << x_slot);
+    pending_count++;
+    slots[x_slot] = command;
+  }
+
+  Command slots[SLOT_COUNT];
+  uint16_t pending_mask;
+  uint8_t pending_count;
+  uint32_t dropped_count;
+};
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * Description:     WiFi/RTDB/stream link state machines with backoff
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include "connection_manager.h"
+#include "logger.h"
+#include "hal/hal.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+static const BackoffPolicy LINK_POLICIES[LINK_COUNT] = {
+  { 250, 30000, 10000 },  // WiFi
+  { 250, 30000, 10000 },  // RTDB
+  { 100, 15000, 0 },      // Stream (opening it is a single blocking call)
+};
+
+static const char* const LINK_NAMES[LINK_COUNT] = { "WiFi", "RTDB", "Stream" };
+
+// A link has to stay up this long before its attempt counter resets
+const uint32_t LINK_STABLE_MS = 10000;
+
+
+struct Link {
+  LinkState state;
+  uint8_t attempt;
+  uint32_t deadline_ms;   // end of backoff, or connect timeout
+  uint32_t up_since_ms;
+};
+
+static Link links[LINK_COUNT];
+static StreamOpener stream_opener = NULL;
+
+uint32_t backoff_delay_ms(const BackoffPolicy& policy, uint8_t attempt, uint32_t random) {
+  uint32_t delay = policy.base_ms;
+  for (uint8_t i = 0; i < attempt && delay < policy.max_ms; i++) delay *= 2;
+  if (delay > policy.max_ms) delay = policy.max_ms;
+
+  uint32_t half = delay / 2;
+  return delay - half + (uint32_t)(((uint64_t)half * random) >> 32);
+}
+
+static bool deadline_passed(uint32_t now_ms, uint32_t deadline_ms) {
+  return (int32_t)(now_ms - deadline_ms) >= 0;
+}
+
+static void mark_up(LinkId id, uint32_t now_ms) {
+  links[id].state = LINK_UP;
+  links[id].up_since_ms = now_ms;
+  uint32_t free_heap = hal_free_heap();
+  if (free_heap == 0) LOGGER_INFO("%s connected", LINK_NAMES[id]);
+  else LOGGER_INFO("%s connected, %u bytes of heap free", LINK_NAMES[id], (unsigned)free_heap);
+}
+
+static void schedule_retry(LinkId id, uint32_t now_ms) {
+  Link& link = links[id];
+  if (link.state == LINK_UP && now_ms - link.up_since_ms >= LINK_STABLE_MS) link.attempt = 0;
+
+  uint32_t delay = backoff_delay_ms(LINK_POLICIES[id], link.attempt, hal_random());
+  if (link.attempt < 31) link.attempt++;
+  link.state = LINK_BACKOFF;
+  link.deadline_ms = now_ms + delay;
+  LOGGER_WARN("%s down. Retrying in %u ms", LINK_NAMES[id], (unsigned)delay);
+}
+
+static void start_connecting(LinkId id, uint32_t now_ms) {
+  links[id].state = LINK_CONNECTING;
+  links[id].deadline_ms = now_ms + LINK_POLICIES[id].connect_timeout_ms;
+}
+
+// Takes a link down because the one below it dropped. It reconnects without
+// waiting once the lower link is back.
+static void drop_link(LinkId id, uint32_t now_ms) {
+  Link& link = links[id];
+  if (link.state == LINK_DOWN) return;
+  if (link.state == LINK_UP && now_ms - link.up_since_ms >= LINK_STABLE_MS) link.attempt = 0;
+  link.state = LINK_DOWN;
+}
+
+static void tick_wifi(uint32_t now_ms) {
+  Link& link = links[LINK_WIFI];
+  bool connected = hal_wifi_connected();
+
+  switch (link.state) {
+    case LINK_UP:
+      if (!connected) schedule_retry(LINK_WIFI, now_ms);
+      break;
+
+    case LINK_DOWN:
+    case LINK_CONNECTING:
+      if (connected) mark_up(LINK_WIFI, now_ms);
+      else if (link.state == LINK_DOWN) start_connecting(LINK_WIFI, now_ms);
+      else if (deadline_passed(now_ms, link.deadline_ms)) schedule_retry(LINK_WIFI, now_ms);
+      break;
+
+    case LINK_BACKOFF:
+      if (connected) mark_up(LINK_WIFI, now_ms);
+      else if (deadline_passed(now_ms, link.deadline_ms)) {
+        hal_wifi_reconnect();
+        start_connecting(LINK_WIFI, now_ms);
+      }
+      break;
+  }
+}
+
+static void tick_rtdb(uint32_t now_ms) {
+  Link& link = links[LINK_RTDB];
+  bool ready = hal_rtdb_ready();
+
+  switch (link.state) {
+    case LINK_UP:
+      if (!ready) schedule_retry(LINK_RTDB, now_ms);
+      break;
+
+    case LINK_DOWN:
+    case LINK_CONNECTING:
+      if (ready) mark_up(LINK_RTDB, now_ms);
+      else if (link.state == LINK_DOWN) start_connecting(LINK_RTDB, now_ms);
+      else if (deadline_passed(now_ms, link.deadline_ms)) schedule_retry(LINK_RTDB, now_ms);
+      break;
+
+    case LINK_BACKOFF:
+      if (ready) mark_up(LINK_RTDB, now_ms);
+      else if (deadline_passed(now_ms, link.deadline_ms)) {
+        hal_rtdb_reconnect();
+        start_connecting(LINK_RTDB, now_ms);
+      }
+      break;
+  }
+}
+
+static void tick_stream(uint32_t now_ms) {
+  Link& link = links[LINK_STREAM];
+  if (link.state == LINK_UP) return;
+  if (link.state == LINK_BACKOFF && !deadline_passed(now_ms, link.deadline_ms)) return;
+
+  if (stream_opener != NULL && stream_opener()) mark_up(LINK_STREAM, now_ms);
+  else {
+    LOGGER_ERROR("Failed to open device stream: %s", hal_net_error());
+    schedule_retry(LINK_STREAM, now_ms);
+  }
+}
+
+void connection_manager_begin(StreamOpener open_stream) {
+  stream_opener = open_stream;
+  for (uint8_t i = 0; i < LINK_COUNT; i++) {
+    links[i].state = LINK_DOWN;
+    links[i].attempt = 0;
+    links[i].deadline_ms = 0;
+    links[i].up_since_ms = 0;
+  }
+}
+
+void connection_manager_tick(uint32_t now_ms) {
+  tick_wifi(now_ms);
+  if (links[LINK_WIFI].state != LINK_UP) {
+    drop_link(LINK_RTDB, now_ms);
+    drop_link(LINK_STREAM, now_ms);
+    return;
+  }
+
+  tick_rtdb(now_ms);
+  if (links[LINK_RTDB].state != LINK_UP) {
+    drop_link(LINK_STREAM, now_ms);
+    return;
+  }
+
+  tick_stream(now_ms);
+}
+
+void connection_manager_stream_failed(uint32_t now_ms) {
+  if (links[LINK_STREAM].state == LINK_UP) schedule_retry(LINK_STREAM, now_ms);
+}
+
+LinkState connection_manager_state(LinkId link) {
+  return links[link].state;
+}
+
+bool connection_manager_stream_up(void) {
+  return links[LINK_STREAM].state == LINK_UP;
+}
@@ -0,0 +1,67 @@
+/**
+ * Description:     Non-blocking connection manager for the WiFi, RTDB and
+ *                  device stream links.
+ *
+ *                  Each link is a small state machine (down, connecting, up,
+ *                  backoff) advanced by connection_manager_tick() from the
+ *                  network task, so nothing in here ever sleeps. A link only
+ *                  comes up once the link below it is up, and dropping a link
+ *                  takes everything above it down with it.
+ *
+ *                  Failed attempts are retried after an exponential backoff
+ *                  with jitter (half fixed, half random), so a brief WiFi blip
+ *                  costs one short interval while a real outage backs off to
+ *                  the cap instead of hammering the AP. The attempt counter
+ *                  only resets once a link has stayed up for a while, so a
+ *                  link that flaps still backs off.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef CONNECTION_MANAGER_H
+#define CONNECTION_MANAGER_H
+
+#include <stdint.h>
+
+enum LinkId : uint8_t {
+  LINK_WIFI = 0,
+  LINK_RTDB,
+  LINK_STREAM,
+  LINK_COUNT
+};
+
+enum LinkState : uint8_t {
+  LINK_DOWN = 0,
+  LINK_CONNECTING,
+  LINK_UP,
+  LINK_BACKOFF
+};
+
+struct BackoffPolicy {
+  uint32_t base_ms;             // delay before the first retry
+  uint32_t max_ms;              // cap on the delay
+  uint32_t connect_timeout_ms;  // give up on an attempt after this long
+};
+
+// Delay before retry number attempt (0 based): min(max, base * 2^attempt),
+// of which the upper half is scaled by random / 2^32
+uint32_t backoff_delay_ms(const BackoffPolicy& policy, uint8_t attempt, uint32_t random);
+
+// Opens the device stream. Called whenever the stream link needs to come up.
+typedef bool (*StreamOpener)(void);
+
+// Start connecting. WiFi must already have been begun.
+void connection_manager_begin(StreamOpener open_stream);
+
+// Advance every link. Never blocks.
+void connection_manager_tick(uint32_t now_ms);
+
+// Report that the stream timed out or failed while it was up
+void connection_manager_stream_failed(uint32_t now_ms);
+
+LinkState connection_manager_state(LinkId link);
+
+bool connection_manager_stream_up(void);
+
+#endif
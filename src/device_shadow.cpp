@@ -0,0 +1,176 @@
+/**
+ * Description:     Desired state diffing and the /reported mirror
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "device_shadow.h"
+#include "actuators.h"
+#include "device_table.h"
+#include "logger.h"
+#include "hal/hal.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+#define SHADOW_REPORTED_PATH "/reported"
+
+// How often the applied state is compared with the desired state
+const uint32_t SHADOW_RECONCILE_INTERVAL_MS = 1000;
+
+// Writing /reported blocks the stream for a whole request, so it waits until
+// the applied state and the desired version have held still this long (ex: a
+// joystick drag is reported once, when it ends)...
+const uint32_t SHADOW_REPORT_SETTLE_MS = 3000;
+
+// ...but a change is not held back longer than this while it keeps changing
+const uint32_t SHADOW_REPORT_MAX_DELAY_MS = 60000;
+
+// Every row path, its value and the version, with room to spare
+const size_t SHADOW_REPORT_JSON_SIZE = 64 + DEVICE_CHANNEL_COUNT * 48;
+
+
+static int16_t desired[DEVICE_CHANNEL_COUNT];
+static uint32_t desired_version = 0;
+static bool version_known = false;
+
+// Last state written to /reported
+static int16_t reported[DEVICE_CHANNEL_COUNT];
+static uint32_t reported_version = 0;
+static bool reported_once = false;
+static bool version_reported = false;
+
+// Rows that differed from the desired state at the last reconcile
+static bool out_of_step[DEVICE_CHANNEL_COUNT];
+
+static uint32_t last_reconcile_ms = 0;
+
+// State seen at the last reconcile, for settling the report
+static int16_t previous_applied[DEVICE_CHANNEL_COUNT];
+static uint32_t previous_version = 0;
+static uint32_t last_change_ms = 0;
+static uint32_t first_change_ms = 0;
+static bool report_pending = false;
+
+void shadow_begin(void) {
+  actuators_values(desired);
+  memcpy(reported, desired, sizeof(reported));
+  memcpy(previous_applied, desired, sizeof(previous_applied));
+}
+
+void shadow_set_version(uint32_t version) {
+  desired_version = version;
+  version_known = true;
+}
+
+// A pose is desired as its two axes, in whole degrees. It is only a repeat
+// if it lands exactly on them, so sub-degree moves still reach the servos.
+static bool accept_pose(const Command& command) {
+  uint8_t x_row = device_row_for_command(command.device, CHANNEL_X);
+  uint8_t y_row = device_row_for_command(command.device, CHANNEL_Y);
+  if (x_row == DEVICE_NO_ROW || y_row == DEVICE_NO_ROW) return true;
+  int16_t x_tenths = pose_x(command.value);
+  int16_t y_tenths = pose_y(command.value);
+  if (desired[x_row] * POSE_UNITS_PER_DEGREE == x_tenths && desired[y_row] * POSE_UNITS_PER_DEGREE == y_tenths) {
+    return false;
+  }
+  desired[x_row] = pose_whole_degrees(x_tenths);
+  desired[y_row] = pose_whole_degrees(y_tenths);
+  return true;
+}
+
+bool shadow_accept(const Command& command) {
+  if (command.channel == CHANNEL_POSE) return accept_pose(command);
+  uint8_t row = device_row_for_command(command.device, command.channel);
+  if (row == DEVICE_NO_ROW) return true;
+  if (desired[row] == command.value) return false;
+  desired[row] = (int16_t)command.value;
+  return true;
+}
+
+// Writes the fields that changed since the last report, and the version once
+// the device has converged on it. Kept as-is on failure, so the next call
+// retries. Returns false only if the write failed.
+static bool write_report(const int16_t applied[DEVICE_CHANNEL_COUNT], bool converged) {
+  char json[SHADOW_REPORT_JSON_SIZE];
+  int length = snprintf(json, sizeof(json), "{");
+  const char* separator = "";
+
+  for (uint8_t row = 0; row < DEVICE_CHANNEL_COUNT; row++) {
+    if (reported_once && applied[row] == reported[row]) continue;
+    // Keys are relative to SHADOW_REPORTED_PATH
+    length += snprintf(json + length, sizeof(json) - length, "%s\"%s\":%d", separator, DEVICE_TABLE[row].path + 1,
+                       applied[row]);
+    separator = ",";
+  }
+
+  bool report_version = converged && version_known && (!version_reported || reported_version != desired_version);
+  if (report_version) {
+    length += snprintf(json + length, sizeof(json) - length, "%s\"version\":%u", separator, (unsigned)desired_version);
+    separator = ",";
+  }
+
+  // Nothing changed
+  if (*separator == '\0') return true;
+  length += snprintf(json + length, sizeof(json) - length, "}");
+  if ((size_t)length >= sizeof(json)) {
+    LOGGER_ERROR("Reported state does not fit");
+    return true;
+  }
+
+  if (!hal_rtdb_update_json(SHADOW_REPORTED_PATH, json)) {
+    LOGGER_WARN("Failed to write reported state: %s", hal_net_error());
+    return false;
+  }
+  memcpy(reported, applied, sizeof(reported));
+  reported_once = true;
+  if (report_version) {
+    reported_version = desired_version;
+    version_reported = true;
+  }
+  return true;
+}
+
+void shadow_reconcile(uint32_t now_ms, CommandSink resubmit) {
+  if (now_ms - last_reconcile_ms < SHADOW_RECONCILE_INTERVAL_MS) return;
+  last_reconcile_ms = now_ms;
+
+  int16_t applied[DEVICE_CHANNEL_COUNT];
+  actuators_values(applied);
+
+  // A row only just submitted may not be applied yet, so it has to be out
+  // of step at two reconciles in a row before it is sent again
+  bool converged = true;
+  for (uint8_t row = 0; row < DEVICE_CHANNEL_COUNT; row++) {
+    if (applied[row] == desired[row]) {
+      out_of_step[row] = false;
+      continue;
+    }
+    converged = false;
+    if (!out_of_step[row]) {
+      out_of_step[row] = true;
+      continue;
+    }
+
+    const DeviceChannel& entry = DEVICE_TABLE[row];
+    LOGGER_WARN("%s is %d, wanted %d. Resubmitting", entry.path, applied[row], desired[row]);
+    Command command = { entry.device, entry.channel, desired[row], hal_micros() };
+    resubmit(command);
+    out_of_step[row] = false;
+  }
+
+  if (memcmp(applied, previous_applied, sizeof(previous_applied)) != 0 || desired_version != previous_version) {
+    memcpy(previous_applied, applied, sizeof(previous_applied));
+    previous_version = desired_version;
+    if (!report_pending) first_change_ms = now_ms;
+    report_pending = true;
+    last_change_ms = now_ms;
+  }
+
+  bool settled = now_ms - last_change_ms >= SHADOW_REPORT_SETTLE_MS ||
+                 (report_pending && now_ms - first_change_ms >= SHADOW_REPORT_MAX_DELAY_MS);
+  if (settled && write_report(applied, converged)) report_pending = false;
+}
@@ -0,0 +1,59 @@
+/**
+ * Description:     Desired/reported device shadow.
+ *
+ *                  The desired state is one value per device table row, as
+ *                  last read from the device stream, plus the /version
+ *                  counter beside them that the web app bumps in the same
+ *                  multi-path update as every change.
+ *                  It starts out as the state the actuators restored at boot.
+ *
+ *                  Stream values are diff-applied against it: a value the
+ *                  device already wants is dropped, so the snapshot that opens
+ *                  every (re)connected stream turns into commands only for the
+ *                  fields that changed while the device was away. That
+ *                  snapshot is the single fetch recovery needs.
+ *
+ *                  The reported state mirrors what the actuators actually
+ *                  applied. It is written to /reported (changed fields only,
+ *                  one request), a sibling of the streamed desired state, so
+ *                  it never comes back down the stream. Once every field
+ *                  matches the desired state, /reported/version is set to the
+ *                  desired version, so the dashboard can tell exactly which
+ *                  of its writes the device has converged on. The write
+ *                  blocks the stream, so it waits until the state has held
+ *                  still for a few seconds: a joystick drag is reported once,
+ *                  when it ends. A row that stays out
+ *                  of step (ex: its command was dropped) is submitted again.
+ *
+ *                  Network task only.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef DEVICE_SHADOW_H
+#define DEVICE_SHADOW_H
+
+#include "command.h"
+#include "stream_dispatch.h"
+
+// Desired state version, bumped by the web app with every write
+#define SHADOW_VERSION_PATH "/version"
+
+// Seed the desired and reported state from the restored actuator state.
+// Call after actuators_init().
+void shadow_begin(void);
+
+// Record the desired version read from SHADOW_VERSION_PATH
+void shadow_set_version(uint32_t version);
+
+// Record a decoded command in the desired state. Returns false if it asks for
+// the value already desired, in which case it need not be actuated.
+bool shadow_accept(const Command& command);
+
+// Compare the applied state with the desired state: resubmit rows that are
+// still out of step and write /reported once a change has settled. Rate
+// limited, so cheap to call often.
+void shadow_reconcile(uint32_t now_ms, CommandSink resubmit);
+
+#endif
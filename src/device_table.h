@@ -0,0 +1,173 @@
+/**
+ * Description:     Compile-time device registry.
+ *
+ *                  Every device channel the firmware knows about is one row of
+ *                  DEVICE_TABLE: its RTDB path, the command it decodes to, how
+ *                  it is driven (on/off GPIO or servo), its pin, the range its
+ *                  value is clamped to and its power-on default. The stream
+ *                  subscription, path dispatch, actuation and saved state are
+ *                  all derived from the table at compile time, so adding a
+ *                  device costs one row. Setpoints are in tenths of a degree
+ *                  Celsius.
+ *
+ *                  Dispatch hashes the incoming path once (FNV-1a) and indexes
+ *                  a bucket table built from the row paths, so finding a
+ *                  path's row is one lookup and one strcmp however many rows
+ *                  there are. A static_assert rejects a table whose paths
+ *                  collide; change DEVICE_PATH_HASH_SEED if it fires.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef DEVICE_TABLE_H
+#define DEVICE_TABLE_H
+
+#include <stdint.h>
+#include <string.h>
+#include "command.h"
+#include "gpio.h"
+#include "motion_planner.h"
+
+enum DeviceKind : uint8_t {
+  DEVICE_KIND_SWITCH = 0,   // on/off GPIO output
+  DEVICE_KIND_SERVO,        // motion planner axis
+  DEVICE_KIND_HEATER,       // thermostat output and master switch
+  DEVICE_KIND_SETPOINT      // thermostat setpoint; pin is the sensor input
+};
+
+struct DeviceChannel {
+  const char* path;         // RTDB path under the device stream
+  uint8_t device;           // DeviceId
+  uint8_t channel;
+  DeviceKind kind;
+  uint8_t pin;
+  uint8_t axis;             // ServoAxis, AXIS_COUNT for everything else
+  int16_t min_value;
+  int16_t max_value;
+  int16_t default_value;
+};
+
+// ============================================================================
+//                                DEVICE TABLE
+// ============================================================================
+// TO ADD A NEW PERIPHERAL: add its DeviceId in command.h, its pin in gpio.h
+// and one row here.
+constexpr DeviceChannel DEVICE_TABLE[] = {
+  // path                        device                     channel           kind                  pin                         axis           min  max  default
+  { "/heating_pad/state",        DEVICE_HEATING_PAD,        CHANNEL_STATE,    DEVICE_KIND_HEATER,   HEATING_PAD_PIN,            AXIS_COUNT,    0,   1,   0 },
+  { "/heating_pad/setpoint",     DEVICE_HEATING_PAD,        CHANNEL_SETPOINT, DEVICE_KIND_SETPOINT, TEMPERATURE_SENSOR_ADC_PIN, AXIS_COUNT,    0,   450, 0 },
+  { "/temperature_sensor/state", DEVICE_TEMPERATURE_SENSOR, CHANNEL_STATE,    DEVICE_KIND_SWITCH,   TEMPERATURE_SENSOR_PIN,     AXIS_COUNT,    0,   1,   0 },
+  { "/camera_servo/x_angle",     DEVICE_CAMERA,             CHANNEL_X,        DEVICE_KIND_SERVO,    CAMERA_LEFT_RIGHT_PIN,      AXIS_CAMERA_X, 0,   180, 90 },
+  { "/camera_servo/y_angle",     DEVICE_CAMERA,             CHANNEL_Y,        DEVICE_KIND_SERVO,    CAMERA_UP_DOWN_PIN,         AXIS_CAMERA_Y, 0,   180, 90 },
+  { "/laser_servo/x_angle",      DEVICE_LASER,              CHANNEL_X,        DEVICE_KIND_SERVO,    LASER_LEFT_RIGHT_PIN,       AXIS_LASER_X,  10,  170, 90 },
+  { "/laser_servo/y_angle",      DEVICE_LASER,              CHANNEL_Y,        DEVICE_KIND_SERVO,    LASER_UP_DOWN_PIN,          AXIS_LASER_Y,  10,  170, 90 },
+};
+
+constexpr uint8_t DEVICE_CHANNEL_COUNT = sizeof(DEVICE_TABLE) / sizeof(DEVICE_TABLE[0]);
+
+// Returned by the lookups below when nothing matches
+constexpr uint8_t DEVICE_NO_ROW = 0xFF;
+
+
+// ============================================================================
+//                            COMPILE-TIME HELPERS
+// ============================================================================
+constexpr uint32_t DEVICE_PATH_HASH_SEED = 2166136261u;
+
+// Power of two, at least twice the row count to keep a perfect spread easy
+constexpr uint8_t DEVICE_HASH_BUCKETS = 16;
+
+static_assert(DEVICE_CHANNEL_COUNT < DEVICE_NO_ROW, "Too many device rows");
+static_assert(DEVICE_CHANNEL_COUNT * 2 <= DEVICE_HASH_BUCKETS, "Grow DEVICE_HASH_BUCKETS");
+
+// FNV-1a. Usable at compile time and at run time.
+constexpr uint32_t device_path_hash(const char* path, uint32_t hash = DEVICE_PATH_HASH_SEED) {
+  return *path == '\0' ? hash : device_path_hash(path + 1, (hash ^ (uint8_t)*path) * 16777619u);
+}
+
+constexpr uint8_t device_path_bucket(const char* path) {
+  return device_path_hash(path) & (DEVICE_HASH_BUCKETS - 1);
+}
+
+// First row at or after row whose path lands in bucket
+constexpr uint8_t device_row_in_bucket(uint8_t bucket, uint8_t row = 0) {
+  return row >= DEVICE_CHANNEL_COUNT ? DEVICE_NO_ROW
+       : device_path_bucket(DEVICE_TABLE[row].path) == bucket ? row
+       : device_row_in_bucket(bucket, row + 1);
+}
+
+constexpr uint8_t device_rows_in_bucket(uint8_t bucket, uint8_t row = 0) {
+  return row >= DEVICE_CHANNEL_COUNT ? 0
+       : (device_path_bucket(DEVICE_TABLE[row].path) == bucket ? 1 : 0) + device_rows_in_bucket(bucket, row + 1);
+}
+
+constexpr bool device_buckets_unique(uint8_t bucket = 0) {
+  return bucket >= DEVICE_HASH_BUCKETS ||
+         (device_rows_in_bucket(bucket) <= 1 && device_buckets_unique(bucket + 1));
+}
+
+static_assert(device_buckets_unique(), "Device paths collide in the dispatch table. Change DEVICE_PATH_HASH_SEED.");
+
+// First row of the given kind, or DEVICE_NO_ROW
+constexpr uint8_t device_row_of_kind(DeviceKind kind, uint8_t row = 0) {
+  return row >= DEVICE_CHANNEL_COUNT ? DEVICE_NO_ROW
+       : DEVICE_TABLE[row].kind == kind ? row
+       : device_row_of_kind(kind, row + 1);
+}
+
+// Row driving a command slot (device * CHANNELS_PER_DEVICE + channel)
+constexpr uint8_t device_row_for_slot(uint8_t slot, uint8_t row = 0) {
+  return row >= DEVICE_CHANNEL_COUNT ? DEVICE_NO_ROW
+       : DEVICE_TABLE[row].device * CHANNELS_PER_DEVICE + DEVICE_TABLE[row].channel == slot ? row
+       : device_row_for_slot(slot, row + 1);
+}
+
+template <uint8_t... I> struct IndexList {};
+template <uint8_t N, uint8_t... I> struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template <uint8_t... I> struct MakeIndexList<0, I...> { typedef IndexList<I...> type; };
+
+// Tables generated from DEVICE_TABLE, one entry per index in the list
+template <typename Rows, typename Buckets, typename Slots> struct DeviceTableIndex;
+
+template <uint8_t... ROW, uint8_t... BUCKET, uint8_t... SLOT>
+struct DeviceTableIndex<IndexList<ROW...>, IndexList<BUCKET...>, IndexList<SLOT...> > {
+  // Row paths, in table order (handed to the stream as its watched paths)
+  static constexpr const char* paths[sizeof...(ROW)] = { DEVICE_TABLE[ROW].path... };
+
+  // Row for each hash bucket
+  static constexpr uint8_t bucket_rows[sizeof...(BUCKET)] = { device_row_in_bucket(BUCKET)... };
+
+  // Row for each command slot
+  static constexpr uint8_t slot_rows[sizeof...(SLOT)] = { device_row_for_slot(SLOT)... };
+};
+
+template <uint8_t... ROW, uint8_t... BUCKET, uint8_t... SLOT>
+constexpr const char* DeviceTableIndex<IndexList<ROW...>, IndexList<BUCKET...>, IndexList<SLOT...> >::paths[];
+template <uint8_t... ROW, uint8_t... BUCKET, uint8_t... SLOT>
+constexpr uint8_t DeviceTableIndex<IndexList<ROW...>, IndexList<BUCKET...>, IndexList<SLOT...> >::bucket_rows[];
+template <uint8_t... ROW, uint8_t... BUCKET, uint8_t... SLOT>
+constexpr uint8_t DeviceTableIndex<IndexList<ROW...>, IndexList<BUCKET...>, IndexList<SLOT...> >::slot_rows[];
+
+typedef DeviceTableIndex<MakeIndexList<DEVICE_CHANNEL_COUNT>::type,
+                         MakeIndexList<DEVICE_HASH_BUCKETS>::type,
+                         MakeIndexList<DEVICE_COUNT * CHANNELS_PER_DEVICE>::type> DeviceIndex;
+
+
+// ============================================================================
+//                                  LOOKUPS
+// ============================================================================
+// Row registered at path, or DEVICE_NO_ROW
+inline uint8_t device_row_for_path(const char* path) {
+  uint8_t row = DeviceIndex::bucket_rows[device_path_bucket(path)];
+  if (row == DEVICE_NO_ROW || strcmp(path, DEVICE_TABLE[row].path) != 0) return DEVICE_NO_ROW;
+  return row;
+}
+
+// Row a command addresses, or DEVICE_NO_ROW
+inline uint8_t device_row_for_command(uint8_t device, uint8_t channel) {
+  if (device >= DEVICE_COUNT || channel >= CHANNELS_PER_DEVICE) return DEVICE_NO_ROW;
+  return DeviceIndex::slot_rows[device * CHANNELS_PER_DEVICE + channel];
+}
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * Description:     Fixed-point decimation filters for analog inputs.
+ *
+ *                  Raw conversions arrive in DMA frames of a few hundred
+ *                  samples. Each input runs through three stages:
+ *
+ *                    BlockAverage    mean of one frame's conversions, kept
+ *                                    with FILTER_FRACTION_BITS extra bits so
+ *                                    the averaging gain is not rounded away
+ *                    MedianFilter    median of the last few block means,
+ *                                    drops single-frame spikes (ex: WiFi TX
+ *                                    bursts, relay switching)
+ *                    FirDecimator    low-pass FIR emitting one output every
+ *                                    `factor` inputs
+ *
+ *                  Integer arithmetic only, no allocation and no platform
+ *                  dependencies, so the kernels build and run unchanged on
+ *                  the host.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Fraction bits carried from the block average onward
+const uint8_t FILTER_FRACTION_BITS = 4;
+
+// Drop the fraction bits of a filtered value, rounding to nearest
+inline int32_t filter_to_integer(int32_t value) {
+  return (value + (1 << (FILTER_FRACTION_BITS - 1))) >> FILTER_FRACTION_BITS;
+}
+
+// 8-tap binomial low-pass in Q15. The taps sum to exactly 1.0, so a constant
+// input comes out unchanged.
+const uint8_t FIR_BINOMIAL_TAPS = 8;
+const int16_t FIR_BINOMIAL_Q15[FIR_BINOMIAL_TAPS] = { 256, 1792, 5376, 8960, 8960, 5376, 1792, 256 };
+
+
+// ============================================================================
+//                                BLOCK AVERAGE
+// ============================================================================
+class BlockAverage {
+public:
+  BlockAverage() : sum(0), count(0) {}
+
+  void add(uint16_t raw) {
+    sum += raw;
+    count++;
+  }
+
+  // Mean of everything added since the last take(), with fraction bits.
+  // Returns false if nothing was added.
+  bool take(int32_t& mean) {
+    if (count == 0) return false;
+    mean = (int32_t)((((uint64_t)sum << FILTER_FRACTION_BITS) + count / 2) / count);
+    sum = 0;
+    count = 0;
+    return true;
+  }
+
+private:
+  uint32_t sum;
+  uint32_t count;
+};
+
+
+// ============================================================================
+//                                MEDIAN FILTER
+// ============================================================================
+// Running median of the last N inputs. Until N inputs have been seen it is
+// the median of those there are.
+template <uint8_t N>
+class MedianFilter {
+  static_assert(N % 2 == 1, "MedianFilter needs an odd window");
+
+public:
+  MedianFilter() { reset(); }
+
+  void reset(void) {
+    next = 0;
+    count = 0;
+  }
+
+  int32_t push(int32_t input) {
+    window[next] = input;
+    next = (next + 1) % N;
+    if (count < N) count++;
+
+    // Insertion sort of a copy; N is a handful of values
+    int32_t sorted[N];
+    for (uint8_t i = 0; i < count; i++) {
+      int32_t value = window[i];
+      uint8_t j = i;
+      while (j > 0 && sorted[j - 1] > value) {
+        sorted[j] = sorted[j - 1];
+        j--;
+      }
+      sorted[j] = value;
+    }
+    return sorted[count / 2];
+  }
+
+private:
+  int32_t window[N];
+  uint8_t next;
+  uint8_t count;
+};
+
+
+// ============================================================================
+//                                FIR DECIMATOR
+// ============================================================================
+// FIR filter with Q15 taps that keeps every input in its history but only
+// computes (and returns) every factor-th output. The history is filled with
+// the first input, so the first outputs are not dragged toward zero.
+template <uint8_t TAPS>
+class FirDecimator {
+public:
+  FirDecimator() : taps(NULL), factor(1) { reset(); }
+
+  void begin(const int16_t (&coefficients)[TAPS], uint16_t decimation) {
+    taps = coefficients;
+    factor = decimation > 0 ? decimation : 1;
+    reset();
+  }
+
+  void reset(void) {
+    next = 0;
+    phase = 0;
+    primed = false;
+  }
+
+  // Returns true when output was produced
+  bool push(int32_t input, int32_t& output) {
+    if (!primed) {
+      for (uint8_t i = 0; i < TAPS; i++) history[i] = input;
+      primed = true;
+    }
+    history[next] = input;
+    next = (next + 1) % TAPS;
+
+    if (++phase < factor) return false;
+    phase = 0;
+
+    // Oldest sample first; next now points at it
+    int64_t accumulator = 0;
+    for (uint8_t i = 0; i < TAPS; i++) {
+      accumulator += (int32_t)taps[i] * history[(next + i) % TAPS];
+    }
+    output = (int32_t)((accumulator + (1 << 14)) >> 15);
+    return true;
+  }
+
+private:
+  const int16_t* taps;
+  uint16_t factor;
+  int32_t history[TAPS];
+  uint8_t next;
+  uint16_t phase;
+  bool primed;
+};
+
+#endif
@@ -2,7 +2,7 @@
  * Description:     Holds all firebase configuration objects
  * 
  * Author:          Eddie Kwak
- * Last Modified:   11/15/2025
+ * Last Modified:   10/15/2026
  */
 
 #ifndef FIREBASE_CONFIG_H
@@ -10,13 +10,8 @@
 
 #include <FirebaseESP32.h>
 
-// Holds RTDB data and stream info
-FirebaseData heating_pad_data;
-FirebaseData temperature_sensor_data;
-FirebaseData camera_x_angle_data;
-FirebaseData camera_y_angle_data;
-FirebaseData laser_x_angle_data;
-FirebaseData laser_y_angle_data;
+// Session for writes. The device stream has its own socket in the HAL.
+FirebaseData device_write_data;
 
 // Firebase auth object
 FirebaseAuth firebase_auth;
@@ -2,13 +2,13 @@
  * Description:     Contains GPIO pin definitions
  * 
  * Author:          Eddie Kwak
- * Last Modified:   11/15/2025
+ * Last Modified:   10/15/2026
  */
 
 #ifndef GPIO_H
 #define GPIO_H
 
-#include <Arduino.h>
+#include <stdint.h>
 
 const uint8_t HEATING_PAD_PIN = 5;
 const uint8_t TEMPERATURE_SENSOR_PIN = 18;
@@ -17,4 +17,8 @@ const uint8_t CAMERA_UP_DOWN_PIN = 32;
 const uint8_t LASER_LEFT_RIGHT_PIN = 26;
 const uint8_t LASER_UP_DOWN_PIN = 25;
 
+// Thermistor divider output (ADC1, input only). The divider is powered from
+// TEMPERATURE_SENSOR_PIN, so it only reads while the sensor is switched on.
+const uint8_t TEMPERATURE_SENSOR_ADC_PIN = 34;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,272 @@
+/**
+ * Description:     Hardware abstraction layer
+ *
+ *                  Everything the control code needs from the platform goes
+ *                  through these functions: GPIO, servos, ADC, clock, timers,
+ *                  tasks, console, persistent storage and the RTDB
+ *                  connection. There are two
+ *                  backends:
+ *
+ *                    hal_esp32.cpp   Arduino/ESP-IDF, FirebaseESP32, LEDC
+ *                    hal_host.cpp    Linux, std::thread, stream from stdin,
+ *                                    a stand-in or a recording
+ *
+ *                  Each backend is guarded by ARDUINO, so both can sit in src/
+ *                  and PlatformIO picks the right one for the environment.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <atomic>
+#endif
+
+// ============================================================================
+//                                    GPIO
+// ============================================================================
+void hal_gpio_output(uint8_t pin);
+void hal_gpio_write(uint8_t pin, bool high);
+
+
+// ============================================================================
+//                                   SERVOS
+// ============================================================================
+// Channels are small indices chosen by the caller (ex: ServoAxis). All of
+// them share one 50 Hz PWM timer.
+const uint8_t HAL_SERVO_CHANNELS = 4;
+const uint32_t HAL_SERVO_PERIOD_US = 20000;
+
+// Start a channel's PWM output on pin, centered (1500 us)
+void hal_servo_attach(uint8_t channel, uint8_t pin);
+
+// Set every channel's pulse width in microseconds. New widths are latched at
+// the next period boundary, so a pulse is never cut short or stretched
+// mid-period. Safe from timer callbacks and ISRs; never blocks.
+void hal_servo_write_all(const uint16_t pulse_us[HAL_SERVO_CHANNELS]);
+
+
+// ============================================================================
+//                                     ADC
+// ============================================================================
+// Continuous (DMA) conversion: the pins are converted in turn by hardware
+// and the results handed over a frame at a time, so no CPU waits on a
+// conversion. Raw values are 12-bit.
+const uint8_t HAL_ADC_MAX_INPUTS = 4;
+const uint16_t HAL_ADC_MAX_FRAME_SAMPLES = 512;
+const uint16_t HAL_ADC_MAX_RAW = 4095;
+
+struct HalAdcSample {
+  uint8_t input;            // index into the pins given to hal_adc_continuous_begin()
+  uint16_t raw;
+};
+
+// Start converting pins at sample_rate_hz (all pins together), delivered in
+// frames of frame_samples conversions. Call once. On the ESP32 only ADC1
+// pins (GPIO 32-39) can be used and the rate is at least 20 kHz.
+bool hal_adc_continuous_begin(const uint8_t* pins, uint8_t count, uint32_t sample_rate_hz, uint16_t frame_samples);
+
+// Block for up to timeout_ms until the next frame is ready and copy it out.
+// Returns the number of samples written, 0 on timeout.
+size_t hal_adc_continuous_read(HalAdcSample* samples, size_t max_samples, uint32_t timeout_ms);
+
+// Calibrated millivolts for a raw value
+uint32_t hal_adc_raw_to_mv(uint16_t raw);
+
+
+// ============================================================================
+//                                    CLOCK
+// ============================================================================
+uint32_t hal_millis(void);
+uint32_t hal_micros(void);
+
+// Free-running CPU cycle counter for timing short sections. On the ESP32 it
+// is per core, so start and end must be read on the same core.
+uint32_t hal_cycles(void);
+uint32_t hal_cycles_per_us(void);
+
+// Blocking delay. Only for setup code; tasks should use hal_task_delay_ms().
+void hal_delay_ms(uint32_t ms);
+
+// Calls callback(arg) every period_us from a timer context. The callback
+// must be short and must not block.
+bool hal_timer_start_periodic(void (*callback)(void*), void* arg, uint32_t period_us);
+
+// Uniform 32-bit random number (ex: for retry jitter)
+uint32_t hal_random(void);
+
+
+// ============================================================================
+//                               CRITICAL SECTIONS
+// ============================================================================
+// Short spinlock for data shared between tasks and timer callbacks
+#ifdef ARDUINO
+typedef portMUX_TYPE HalSpinlock;
+#define HAL_SPINLOCK_INIT portMUX_INITIALIZER_UNLOCKED
+inline void hal_spin_lock(HalSpinlock* lock) { portENTER_CRITICAL(lock); }
+inline void hal_spin_unlock(HalSpinlock* lock) { portEXIT_CRITICAL(lock); }
+#else
+struct HalSpinlock { std::atomic_flag flag; };
+#define HAL_SPINLOCK_INIT { ATOMIC_FLAG_INIT }
+inline void hal_spin_lock(HalSpinlock* lock) { while (lock->flag.test_and_set(std::memory_order_acquire)) {} }
+inline void hal_spin_unlock(HalSpinlock* lock) { lock->flag.clear(std::memory_order_release); }
+#endif
+
+
+// ============================================================================
+//                                    TASKS
+// ============================================================================
+#ifdef ARDUINO
+typedef TaskHandle_t HalTask;
+#else
+typedef struct HostTask* HalTask;
+#endif
+
+// Start fn(arg) as a task. core is a hint (-1 for any) and is ignored on the host.
+bool hal_task_start(void (*fn)(void*), const char* name, uint32_t stack_size, uint8_t priority,
+                    int8_t core, void* arg, HalTask* handle);
+
+HalTask hal_task_current(void);
+
+// Wake a task blocked in hal_task_wait_notify(). Notifications given before
+// the task waits are not lost.
+void hal_task_notify(HalTask task);
+
+// Block the calling task until it is notified
+void hal_task_wait_notify(void);
+
+void hal_task_delay_ms(uint32_t ms);
+
+// Give up the CPU for the shortest schedulable interval
+void hal_task_yield_tick(void);
+
+// End the calling task (used by the Arduino loop task)
+void hal_task_exit(void);
+
+
+// ============================================================================
+//                                   CONSOLE
+// ============================================================================
+void hal_console_begin(uint32_t baud);
+
+// Blocks until the text is queued to the console. Firmware code logs through
+// logger.h instead, so only the logger task ever waits on the UART.
+void hal_console_write(const char* text, size_t length);
+
+
+// ============================================================================
+//                                   STORAGE
+// ============================================================================
+// Small blobs that survive a reboot (NVS on the ESP32, files under
+// $HAL_STORAGE_DIR on the host). Keys are at most 15 characters. Only the
+// setup code and the network task touch storage, so it is not locked.
+
+// Returns false if key is missing or was stored with a different size
+bool hal_storage_read(const char* key, void* data, size_t size);
+bool hal_storage_write(const char* key, const void* data, size_t size);
+
+
+// ============================================================================
+//                                   NETWORK
+// ============================================================================
+// Receives every device value carried by one stream event, keyed by its
+// RTDB path under the stream path (ex: "/laser_servo/x_angle")
+typedef void (*HalStreamValueSink)(const char* path, int value);
+
+// Receives string values the same way (ex: base64 servo frames). text is
+// only valid during the call.
+typedef void (*HalStreamTextSink)(const char* path, const char* text);
+
+// Result of hal_stream_read()
+enum HalStreamResult : uint8_t {
+  HAL_STREAM_IDLE = 0,      // nothing pending
+  HAL_STREAM_EVENT,         // one event was delivered to the sink
+  HAL_STREAM_TIMEOUT,       // stream went quiet and must be re-begun
+  HAL_STREAM_ERROR          // read failed, see hal_net_error()
+};
+
+// Start connecting to WiFi. Returns immediately. The backend does not
+// reconnect on its own; the caller drives hal_wifi_reconnect(). Where the
+// platform supports it, the last access point (channel and BSSID) is kept in
+// storage and joined directly, skipping the scan.
+void hal_wifi_begin(const char* ssid, const char* password);
+bool hal_wifi_connected(void);
+void hal_wifi_reconnect(void);
+
+// Unique id of this board as text (ex: "a1b2c3d4e5f6", the eFuse MAC on the
+// ESP32, $HAL_CHIP_ID or "host" on the host)
+void hal_chip_id(char* buffer, size_t size);
+
+// Configure and start the RTDB client. Every stream and write path below is
+// relative to root (ex: "/devices/a1b2c3d4e5f6"), so towers sharing one
+// database each keep to their own subtree.
+void hal_rtdb_begin(const char* database_url, const char* root);
+bool hal_rtdb_ready(void);
+
+// Ask the RTDB client to re-establish its session after a drop
+void hal_rtdb_reconnect(void);
+
+// Open the device stream on path. watched_paths lists the leaf paths, under
+// path, the caller cares about; snapshot and patch events are resolved
+// against it.
+bool hal_stream_begin(const char* path, const char* const* watched_paths, uint8_t watched_count);
+
+// Read at most one stream event without blocking
+HalStreamResult hal_stream_read(HalStreamValueSink sink, HalStreamTextSink text_sink);
+
+// Host only, the ESP32 never exits: once stdin or a replay has run out, the
+// process exits when settled() has returned true for a few PWM periods, or
+// after a hard cap if it never does. settled() is called from the task that
+// reads the stream.
+void hal_stream_set_settled_check(bool (*settled)(void));
+
+// Replace the value at path with a JSON document. Blocks for one request,
+// so only for infrequent writes (ex: diagnostics).
+bool hal_rtdb_set_json(const char* path, const char* json);
+
+// Multi-path update: every key of the JSON object is a path relative to
+// path (ex: {"a/b": 1, "c": 2}) and only those children are replaced, in one
+// request. Blocks like hal_rtdb_set_json().
+bool hal_rtdb_update_json(const char* path, const char* json);
+
+// Local address on the WiFi network as dotted text. Returns false while not
+// connected.
+bool hal_wifi_local_ip(char* buffer, size_t size);
+
+// LAN control endpoint: clients on the same network send small binary
+// messages straight to the device. On the ESP32 it is a WebSocket server
+// (browsers can reach it); on the host a UDP socket (tools can reach it).
+// Either way each message arrives whole.
+const size_t HAL_LAN_MAX_MESSAGE = 64;
+
+#ifdef ARDUINO
+#define HAL_LAN_TRANSPORT "ws"
+#else
+#define HAL_LAN_TRANSPORT "udp"
+#endif
+
+// Start listening on port. Returns the port actually listened on (the host
+// picks a free one if port is taken), 0 on failure.
+uint16_t hal_lan_begin(uint16_t port);
+
+// Copy out the next message without blocking. Returns its length, 0 if none
+// is pending. Messages longer than size are dropped.
+size_t hal_lan_read(uint8_t* buffer, size_t size);
+
+// Last network error as text
+const char* hal_net_error(void);
+
+// Free heap in bytes, 0 where the backend cannot tell (the host). Logged as
+// each link comes up, so the log shows what each TLS session costs.
+uint32_t hal_free_heap(void);
+
+#endif
@@ -0,0 +1,597 @@
+/**
+ * Description:     ESP32 (Arduino) backend of the hardware abstraction layer
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <Preferences.h>
+#include <WebSocketsServer.h>
+#include <WiFiClientSecure.h>
+#include "esp_timer.h"
+#include "driver/adc.h"
+#include "driver/ledc.h"
+#include "esp_adc_cal.h"
+#include "hal/ledc_ll.h"
+#include "soc/ledc_struct.h"
+#include "hal.h"
+#include "rtdb_root_ca.h"
+#include "sse_parser.h"
+#include "../firebase_config.h"
+
+// ============================================================================
+//                                GPIO / SERVOS
+// ============================================================================
+// Servo channels map 1:1 onto high-speed LEDC channels on one timer. High-
+// speed channels pick up a new duty at the start of the next PWM cycle, which
+// is what makes updates glitch-free.
+static const ledc_mode_t SERVO_LEDC_MODE = LEDC_HIGH_SPEED_MODE;
+static const ledc_timer_t SERVO_LEDC_TIMER = LEDC_TIMER_0;
+static const uint8_t SERVO_DUTY_BITS = 16;   // ~0.3 us per step at 50 Hz
+
+static bool servo_timer_ready = false;
+static bool servo_attached[HAL_SERVO_CHANNELS];
+
+void hal_gpio_output(uint8_t pin) {
+  pinMode(pin, OUTPUT);
+}
+
+void hal_gpio_write(uint8_t pin, bool high) {
+  digitalWrite(pin, high ? HIGH : LOW);
+}
+
+static inline uint32_t IRAM_ATTR servo_duty(uint16_t pulse_us) {
+  return ((uint32_t)pulse_us << SERVO_DUTY_BITS) / HAL_SERVO_PERIOD_US;
+}
+
+void hal_servo_attach(uint8_t channel, uint8_t pin) {
+  if (channel >= HAL_SERVO_CHANNELS) return;
+
+  if (!servo_timer_ready) {
+    ledc_timer_config_t timer = {};
+    timer.speed_mode = SERVO_LEDC_MODE;
+    timer.duty_resolution = (ledc_timer_bit_t)SERVO_DUTY_BITS;
+    timer.timer_num = SERVO_LEDC_TIMER;
+    timer.freq_hz = 1000000 / HAL_SERVO_PERIOD_US;
+    timer.clk_cfg = LEDC_AUTO_CLK;
+    servo_timer_ready = ledc_timer_config(&timer) == ESP_OK;
+    if (!servo_timer_ready) return;
+  }
+
+  ledc_channel_config_t config = {};
+  config.gpio_num = pin;
+  config.speed_mode = SERVO_LEDC_MODE;
+  config.channel = (ledc_channel_t)channel;
+  config.intr_type = LEDC_INTR_DISABLE;
+  config.timer_sel = SERVO_LEDC_TIMER;
+  config.duty = servo_duty(1500);
+  config.hpoint = 0;
+  servo_attached[channel] = ledc_channel_config(&config) == ESP_OK;
+}
+
+// Writes the duty registers directly instead of going through ledc_set_duty(),
+// which takes a lock and lives in flash
+void IRAM_ATTR hal_servo_write_all(const uint16_t pulse_us[HAL_SERVO_CHANNELS]) {
+  for (uint8_t channel = 0; channel < HAL_SERVO_CHANNELS; channel++) {
+    if (!servo_attached[channel]) continue;
+    ledc_ll_set_duty_int_part(&LEDC, SERVO_LEDC_MODE, (ledc_channel_t)channel, servo_duty(pulse_us[channel]));
+    ledc_ll_set_duty_start(&LEDC, SERVO_LEDC_MODE, (ledc_channel_t)channel, true);
+  }
+}
+
+
+// ============================================================================
+//                                     ADC
+// ============================================================================
+// The IDF driver runs ADC1 through I2S0 DMA into a ring of
+// ADC_STORE_FRAMES frames, so one frame is filled while the last is read.
+static const adc_atten_t ADC_ATTENUATION = ADC_ATTEN_DB_11;    // 0 - ~3.1 V
+static const uint8_t ADC_STORE_FRAMES = 2;
+static const uint8_t ADC_NO_INPUT = 0xFF;
+
+static esp_adc_cal_characteristics_t adc_characteristics;
+static uint8_t adc_channel_inputs[ADC1_CHANNEL_MAX];
+static uint16_t adc_frame_bytes = 0;
+static uint8_t adc_frame[HAL_ADC_MAX_FRAME_SAMPLES * SOC_ADC_DIGI_DATA_BYTES_PER_CONV];
+
+bool hal_adc_continuous_begin(const uint8_t* pins, uint8_t count, uint32_t sample_rate_hz, uint16_t frame_samples) {
+  if (count == 0 || count > HAL_ADC_MAX_INPUTS || frame_samples > HAL_ADC_MAX_FRAME_SAMPLES) return false;
+
+  memset(adc_channel_inputs, ADC_NO_INPUT, sizeof(adc_channel_inputs));
+  adc_digi_pattern_config_t pattern[HAL_ADC_MAX_INPUTS] = {};
+  uint32_t channel_mask = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    // Continuous mode only reaches ADC1, which also keeps clear of WiFi
+    int8_t channel = digitalPinToAnalogChannel(pins[i]);
+    if (channel < 0 || channel >= ADC1_CHANNEL_MAX) return false;
+
+    pattern[i].atten = ADC_ATTENUATION;
+    pattern[i].channel = channel;
+    pattern[i].unit = 0;
+    pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    adc_channel_inputs[channel] = i;
+    channel_mask |= 1u << channel;
+  }
+
+  adc_frame_bytes = frame_samples * SOC_ADC_DIGI_DATA_BYTES_PER_CONV;
+  adc_digi_init_config_t init = {};
+  init.max_store_buf_size = adc_frame_bytes * ADC_STORE_FRAMES;
+  init.conv_num_each_intr = adc_frame_bytes;
+  init.adc1_chan_mask = channel_mask;
+  if (adc_digi_initialize(&init) != ESP_OK) return false;
+
+  adc_digi_configuration_t config = {};
+  config.conv_limit_en = true;
+  config.conv_limit_num = 250;
+  config.pattern_num = count;
+  config.adc_pattern = pattern;
+  config.sample_freq_hz = sample_rate_hz;
+  config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+  config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+  if (adc_digi_controller_configure(&config) != ESP_OK) return false;
+
+  esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTENUATION, ADC_WIDTH_BIT_12, 1100, &adc_characteristics);
+  return adc_digi_start() == ESP_OK;
+}
+
+size_t hal_adc_continuous_read(HalAdcSample* samples, size_t max_samples, uint32_t timeout_ms) {
+  uint32_t length = 0;
+  // ESP_ERR_INVALID_STATE means the ring overflowed; the data read is still good
+  esp_err_t result = adc_digi_read_bytes(adc_frame, adc_frame_bytes, &length, timeout_ms);
+  if (result != ESP_OK && result != ESP_ERR_INVALID_STATE) return 0;
+
+  size_t count = 0;
+  for (uint32_t offset = 0; offset + SOC_ADC_DIGI_DATA_BYTES_PER_CONV <= length && count < max_samples;
+       offset += SOC_ADC_DIGI_DATA_BYTES_PER_CONV) {
+    const adc_digi_output_data_t* data = (const adc_digi_output_data_t*)&adc_frame[offset];
+    if (data->type1.channel >= ADC1_CHANNEL_MAX) continue;
+    uint8_t input = adc_channel_inputs[data->type1.channel];
+    if (input == ADC_NO_INPUT) continue;
+
+    samples[count].input = input;
+    samples[count].raw = data->type1.data;
+    count++;
+  }
+  return count;
+}
+
+uint32_t hal_adc_raw_to_mv(uint16_t raw) {
+  return esp_adc_cal_raw_to_voltage(raw, &adc_characteristics);
+}
+
+
+// ============================================================================
+//                                    CLOCK
+// ============================================================================
+uint32_t hal_millis(void) {
+  return millis();
+}
+
+uint32_t hal_micros(void) {
+  return micros();
+}
+
+uint32_t hal_cycles(void) {
+  return ESP.getCycleCount();
+}
+
+uint32_t hal_cycles_per_us(void) {
+  return getCpuFrequencyMhz();
+}
+
+void hal_delay_ms(uint32_t ms) {
+  delay(ms);
+}
+
+bool hal_timer_start_periodic(void (*callback)(void*), void* arg, uint32_t period_us) {
+  esp_timer_create_args_t timer_args = {};
+  timer_args.callback = callback;
+  timer_args.arg = arg;
+  timer_args.name = "hal_periodic";
+
+  esp_timer_handle_t timer = NULL;
+  if (esp_timer_create(&timer_args, &timer) != ESP_OK) return false;
+  return esp_timer_start_periodic(timer, period_us) == ESP_OK;
+}
+
+uint32_t hal_random(void) {
+  return esp_random();
+}
+
+
+// ============================================================================
+//                                    TASKS
+// ============================================================================
+bool hal_task_start(void (*fn)(void*), const char* name, uint32_t stack_size, uint8_t priority,
+                    int8_t core, void* arg, HalTask* handle) {
+  BaseType_t affinity = core < 0 ? tskNO_AFFINITY : core;
+  return xTaskCreatePinnedToCore(fn, name, stack_size, arg, priority, handle, affinity) == pdPASS;
+}
+
+HalTask hal_task_current(void) {
+  return xTaskGetCurrentTaskHandle();
+}
+
+void hal_task_notify(HalTask task) {
+  xTaskNotifyGive(task);
+}
+
+void hal_task_wait_notify(void) {
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+void hal_task_delay_ms(uint32_t ms) {
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void hal_task_yield_tick(void) {
+  vTaskDelay(1);
+}
+
+void hal_task_exit(void) {
+  vTaskDelete(NULL);
+}
+
+
+// ============================================================================
+//                                   CONSOLE
+// ============================================================================
+void hal_console_begin(uint32_t baud) {
+  Serial.begin(baud);
+}
+
+void hal_console_write(const char* text, size_t length) {
+  Serial.write((const uint8_t*)text, length);
+}
+
+
+// ============================================================================
+//                                   STORAGE
+// ============================================================================
+static Preferences storage;
+static bool storage_open = false;
+
+static bool open_storage(void) {
+  if (!storage_open) storage_open = storage.begin("smart_home", false);
+  return storage_open;
+}
+
+bool hal_storage_read(const char* key, void* data, size_t size) {
+  if (!open_storage() || storage.getBytesLength(key) != size) return false;
+  return storage.getBytes(key, data, size) == size;
+}
+
+bool hal_storage_write(const char* key, const void* data, size_t size) {
+  if (!open_storage()) return false;
+  return storage.putBytes(key, data, size) == size;
+}
+
+
+// ============================================================================
+//                                   NETWORK
+// ============================================================================
+// Access point the station last joined. Joining it by channel and BSSID skips
+// the all-channel scan, which is most of the WiFi connect time.
+struct WifiAccessPoint {
+  uint8_t bssid[6];
+  uint8_t channel;
+};
+
+#define WIFI_ACCESS_POINT_KEY "wifi_ap"
+
+// The device stream is read straight off its own TLS socket by SseParser, so
+// events never pass through Strings or a JSON document. Writes still go
+// through the Firebase client, on a second TLS session: the stream holds its
+// HTTP response open for good, so no other request can share its socket.
+// Sharing one session the way FirebaseESP32 does (stop the stream, write,
+// reopen it) would cost a TLS handshake and a fresh snapshot per write, and
+// the stream is deaf in between. The write session is kept open rather than
+// reopened per write for the same reason. Both verify the server against
+// RTDB_ROOT_CA.
+static const uint16_t RTDB_HTTPS_PORT = 443;
+
+// Stream goes quiet for longer than this (the RTDB sends keep-alives every
+// 30 s) and it is reported as timed out
+static const uint32_t STREAM_TIMEOUT_MS = 65000;
+
+// The RTDB answers a stream request with a redirect to the server holding
+// the database, at most this many in a row
+static const uint8_t STREAM_MAX_REDIRECTS = 3;
+
+static WiFiClientSecure stream_client;
+static SseParser stream_parser;
+static char rtdb_host[64];
+static char rtdb_root[48];
+static const char* const* stream_watched_paths = NULL;
+static uint8_t stream_watched_count = 0;
+static uint8_t stream_redirects = 0;
+static uint32_t stream_last_data_ms = 0;
+static char net_error[64] = "";
+
+static const char* wifi_ssid = NULL;
+static const char* wifi_password = NULL;
+static WifiAccessPoint wifi_access_point = {};
+static bool wifi_bssid_locked = false;
+static bool wifi_was_connected = false;
+
+// Stores the access point just joined, if it differs from the stored one
+static void remember_access_point(void) {
+  WifiAccessPoint joined = {};
+  memcpy(joined.bssid, WiFi.BSSID(), sizeof(joined.bssid));
+  joined.channel = WiFi.channel();
+  if (memcmp(&joined, &wifi_access_point, sizeof(joined)) == 0) return;
+
+  wifi_access_point = joined;
+  hal_storage_write(WIFI_ACCESS_POINT_KEY, &wifi_access_point, sizeof(wifi_access_point));
+}
+
+void hal_wifi_begin(const char* ssid, const char* password) {
+  wifi_ssid = ssid;
+  wifi_password = password;
+
+  // Reconnects are paced by the connection manager
+  WiFi.persistent(false);
+  WiFi.setAutoReconnect(false);
+  WiFi.mode(WIFI_STA);
+
+  wifi_bssid_locked = hal_storage_read(WIFI_ACCESS_POINT_KEY, &wifi_access_point, sizeof(wifi_access_point)) &&
+                      wifi_access_point.channel != 0;
+  if (wifi_bssid_locked) WiFi.begin(ssid, password, wifi_access_point.channel, wifi_access_point.bssid);
+  else WiFi.begin(ssid, password);
+}
+
+bool hal_wifi_connected(void) {
+  bool connected = WiFi.status() == WL_CONNECTED;
+  if (connected && !wifi_was_connected) remember_access_point();
+  wifi_was_connected = connected;
+  return connected;
+}
+
+void hal_wifi_reconnect(void) {
+  // The stored access point did not answer (moved channel, replaced router),
+  // so fall back to a full scan for the SSID
+  if (wifi_bssid_locked) {
+    wifi_bssid_locked = false;
+    WiFi.disconnect();
+    WiFi.begin(wifi_ssid, wifi_password);
+    return;
+  }
+  WiFi.reconnect();
+}
+
+// Splits "https://host/target" into its host and target ("/" if none)
+static bool split_url(const char* url, char* host, size_t host_size, const char** target) {
+  const char* start = strstr(url, "://");
+  start = start != NULL ? start + 3 : url;
+  const char* slash = strchr(start, '/');
+  size_t length = slash != NULL ? (size_t)(slash - start) : strlen(start);
+  if (length == 0 || length >= host_size) return false;
+  memcpy(host, start, length);
+  host[length] = '\0';
+  *target = slash != NULL ? slash : "/";
+  return true;
+}
+
+void hal_chip_id(char* buffer, size_t size) {
+  // Factory-programmed base MAC, unique per chip
+  uint64_t mac = ESP.getEfuseMac();
+  snprintf(buffer, size, "%04x%08x", (unsigned)(uint16_t)(mac >> 32), (unsigned)(uint32_t)mac);
+}
+
+// Prefixes the device root to a path (ex: "/a/b" -> "/devices/<id>/a/b")
+static void rooted_path(const char* path, char* buffer, size_t size) {
+  snprintf(buffer, size, "%s%s", rtdb_root, strcmp(path, "/") == 0 ? "" : path);
+}
+
+void hal_rtdb_begin(const char* database_url, const char* root) {
+  snprintf(rtdb_root, sizeof(rtdb_root), "%s", root);
+  size_t root_length = strlen(rtdb_root);
+  while (root_length > 0 && rtdb_root[root_length - 1] == '/') rtdb_root[--root_length] = '\0';
+
+  firebase_config.database_url = database_url;
+  firebase_config.cert.data = RTDB_ROOT_CA;
+  firebase_config.signer.test_mode = true;
+  Firebase.begin(&firebase_config, &firebase_auth);
+  Firebase.reconnectWiFi(false);
+
+  const char* target;
+  if (!split_url(database_url, rtdb_host, sizeof(rtdb_host), &target)) rtdb_host[0] = '\0';
+}
+
+bool hal_rtdb_ready(void) {
+  return Firebase.ready();
+}
+
+void hal_rtdb_reconnect(void) {
+  Firebase.reconnectWiFi(false);
+}
+
+// Connects to host and requests target as an event stream. Blocks for the
+// TLS handshake.
+static bool open_stream(const char* host, const char* target) {
+  stream_client.stop();
+  stream_client.setCACert(RTDB_ROOT_CA);
+  if (!stream_client.connect(host, RTDB_HTTPS_PORT)) {
+    snprintf(net_error, sizeof(net_error), "stream connect failed");
+    return false;
+  }
+
+  char request[SSE_MAX_LOCATION + 128];
+  int length = snprintf(request, sizeof(request),
+                        "GET %s HTTP/1.1\r\nHost: %s\r\nAccept: text/event-stream\r\nConnection: keep-alive\r\n\r\n",
+                        target, host);
+  if (length <= 0 || (size_t)length >= sizeof(request) ||
+      stream_client.write((const uint8_t*)request, (size_t)length) != (size_t)length) {
+    snprintf(net_error, sizeof(net_error), "stream request failed");
+    stream_client.stop();
+    return false;
+  }
+
+  // Values are keyed relative to the stream path, as the RTDB sends them
+  stream_parser.begin("/", stream_watched_paths, stream_watched_count);
+  stream_last_data_ms = millis();
+  return true;
+}
+
+bool hal_stream_begin(const char* path, const char* const* watched_paths, uint8_t watched_count) {
+  stream_watched_paths = watched_paths;
+  stream_watched_count = watched_count;
+  stream_redirects = 0;
+
+  // "/" -> "<root>/.json", "/a/b" -> "<root>/a/b.json"
+  char rooted[sizeof(rtdb_root) + SSE_MAX_PATH];
+  rooted_path(path, rooted, sizeof(rooted));
+  char target[sizeof(rooted) + 8];
+  size_t length = strlen(rooted);
+  while (length > 0 && rooted[length - 1] == '/') length--;
+  snprintf(target, sizeof(target), "%.*s%s", (int)length, rooted, length == 0 ? "/.json" : ".json");
+  return open_stream(rtdb_host, target);
+}
+
+// Follows a redirect to the server holding the database
+static HalStreamResult follow_redirect(void) {
+  char host[sizeof(rtdb_host)];
+  const char* target;
+  if (++stream_redirects > STREAM_MAX_REDIRECTS ||
+      !split_url(stream_parser.location(), host, sizeof(host), &target)) {
+    snprintf(net_error, sizeof(net_error), "stream redirect failed");
+    return HAL_STREAM_ERROR;
+  }
+  return open_stream(host, target) ? HAL_STREAM_IDLE : HAL_STREAM_ERROR;
+}
+
+HalStreamResult hal_stream_read(HalStreamValueSink sink, HalStreamTextSink text_sink) {
+  // Events already buffered go first, one per call
+  SseStatus status = stream_parser.parse(sink, text_sink);
+  if (status == SSE_MORE) {
+    int available = stream_client.available();
+    if (available > 0) {
+      size_t space;
+      char* at = stream_parser.receive_space(space);
+      int n = stream_client.read((uint8_t*)at, min(space, (size_t)available));
+      if (n > 0) {
+        stream_parser.received((size_t)n);
+        stream_last_data_ms = millis();
+        status = stream_parser.parse(sink, text_sink);
+      }
+    }
+    else if (!stream_client.connected()) {
+      snprintf(net_error, sizeof(net_error), "stream closed");
+      return HAL_STREAM_TIMEOUT;
+    }
+    else if (millis() - stream_last_data_ms > STREAM_TIMEOUT_MS) {
+      return HAL_STREAM_TIMEOUT;
+    }
+  }
+
+  switch (status) {
+    case SSE_EVENT:
+      stream_redirects = 0;
+      return HAL_STREAM_EVENT;
+    case SSE_CLOSED:
+      return HAL_STREAM_TIMEOUT;
+    case SSE_REDIRECT:
+      return follow_redirect();
+    case SSE_HTTP_ERROR:
+      snprintf(net_error, sizeof(net_error), "stream HTTP %d", stream_parser.http_status());
+      return HAL_STREAM_ERROR;
+    default:
+      return HAL_STREAM_IDLE;
+  }
+}
+
+// The stream never runs out on the device
+void hal_stream_set_settled_check(bool (*settled)(void)) {
+  (void)settled;
+}
+
+bool hal_rtdb_set_json(const char* path, const char* json) {
+  char rooted[sizeof(rtdb_root) + SSE_MAX_PATH];
+  rooted_path(path, rooted, sizeof(rooted));
+  FirebaseJson document;
+  document.setJsonData(json);
+  if (Firebase.setJSON(device_write_data, rooted, document)) return true;
+  snprintf(net_error, sizeof(net_error), "%s", device_write_data.errorReason().c_str());
+  return false;
+}
+
+// The silent variant skips echoing the written data back over TLS
+bool hal_rtdb_update_json(const char* path, const char* json) {
+  char rooted[sizeof(rtdb_root) + SSE_MAX_PATH];
+  rooted_path(path, rooted, sizeof(rooted));
+  FirebaseJson document;
+  document.setJsonData(json);
+  if (Firebase.updateNodeSilent(device_write_data, rooted, document)) return true;
+  snprintf(net_error, sizeof(net_error), "%s", device_write_data.errorReason().c_str());
+  return false;
+}
+
+bool hal_wifi_local_ip(char* buffer, size_t size) {
+  if (WiFi.status() != WL_CONNECTED) return false;
+  snprintf(buffer, size, "%s", WiFi.localIP().toString().c_str());
+  return true;
+}
+
+// Binary WebSocket messages, queued by the event callback (which runs inside
+// lan_server->loop(), on the calling task) and handed out one per read
+struct LanMessage {
+  uint8_t length;
+  uint8_t data[HAL_LAN_MAX_MESSAGE];
+};
+
+static const uint8_t LAN_QUEUE_DEPTH = 4;
+
+static WebSocketsServer* lan_server = NULL;
+static LanMessage lan_queue[LAN_QUEUE_DEPTH];
+static uint8_t lan_queue_head = 0;
+static uint8_t lan_queue_count = 0;
+
+static void on_lan_event(uint8_t client, WStype_t type, uint8_t* payload, size_t length) {
+  (void)client;
+  if (type != WStype_BIN || length > HAL_LAN_MAX_MESSAGE) return;
+
+  // Newer control messages matter more, so a full queue drops its oldest
+  if (lan_queue_count == LAN_QUEUE_DEPTH) {
+    lan_queue_head = (lan_queue_head + 1) % LAN_QUEUE_DEPTH;
+    lan_queue_count--;
+  }
+  LanMessage& message = lan_queue[(lan_queue_head + lan_queue_count) % LAN_QUEUE_DEPTH];
+  message.length = (uint8_t)length;
+  memcpy(message.data, payload, length);
+  lan_queue_count++;
+}
+
+uint16_t hal_lan_begin(uint16_t port) {
+  if (lan_server != NULL) return 0;
+  lan_server = new WebSocketsServer(port);
+  lan_server->onEvent(on_lan_event);
+  lan_server->begin();
+  return port;
+}
+
+size_t hal_lan_read(uint8_t* buffer, size_t size) {
+  if (lan_server == NULL) return 0;
+  if (lan_queue_count == 0) lan_server->loop();
+  if (lan_queue_count == 0) return 0;
+
+  const LanMessage& message = lan_queue[lan_queue_head];
+  lan_queue_head = (lan_queue_head + 1) % LAN_QUEUE_DEPTH;
+  lan_queue_count--;
+  if (message.length > size) return 0;
+  memcpy(buffer, message.data, message.length);
+  return message.length;
+}
+
+const char* hal_net_error(void) {
+  return net_error;
+}
+
+uint32_t hal_free_heap(void) {
+  return ESP.getFreeHeap();
+}
+
+#endif
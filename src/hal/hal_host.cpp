@@ -0,0 +1,967 @@
+/**
+ * Description:     Linux host backend of the hardware abstraction layer
+ *
+ *                  Tasks are std::threads and timers are threads sleeping on
+ *                  a fixed schedule. WiFi is always "up".
+ *
+ *                  With RTDB_URL=http://<host>:<port> in the environment, the
+ *                  device stream is a real RTDB streaming (SSE) connection to
+ *                  that address, normally tools/rtdb_standin. Otherwise it is
+ *                  read from stdin, one event per line:
+ *
+ *                      <path> <value> [<path> <value> ...]
+ *
+ *                  ex: "/laser_servo/x_angle 120 /laser_servo/y_angle 45".
+ *                  Blank lines and lines starting with '#' are ignored. Once
+ *                  stdin closes and every event has been read, the process
+ *                  exits as soon as the firmware reports its outputs settled
+ *                  (hal_stream_set_settled_check()).
+ *
+ *                  Console output goes to stderr. With HAL_TRACE=1 in the
+ *                  environment, every GPIO write and every latched servo
+ *                  pulse width is printed to stdout as
+ *                  "<monotonic us> gpio <pin> <level>" or
+ *                  "<monotonic us> servo <channel> <pulse us>" for tests and
+ *                  benchmarks to consume.
+ *
+ *                  With HAL_REPLAY=<file>, the stream is instead a recording
+ *                  made with -DSTREAM_RECORDER (see stream_recorder.h): each
+ *                  recorded event is delivered at the same offset from the
+ *                  first one as on the device, and the process exits once
+ *                  the last has settled, like with stdin. With HAL_TRACE=1,
+ *                  each delivery is traced as
+ *                  "<us> event <index> <path> <value> ...".
+ *
+ *                  With HAL_CLOCK=virtual as well, time is simulated: the
+ *                  clock stands still while any task, timer or the PWM
+ *                  thread is running, and jumps to the next wake-up once
+ *                  all of them are blocked in the HAL. Replays then run as
+ *                  fast as the CPU allows, every timestamp (trace lines
+ *                  included) is virtual, counted from 0 at boot, and
+ *                  hal_random() is seeded with a constant. Network and
+ *                  scheduler jitter no longer reach the timeline, so two
+ *                  runs of one recording give the same trace and latency
+ *                  changes can be compared exactly. hal_cycles() stays on
+ *                  the real clock, since it measures CPU cost.
+ *
+ *                  The chip id is $HAL_CHIP_ID ("host" if unset), so
+ *                  instances run side by side each get their own subtree
+ *                  of the stand-in (ex: HAL_CHIP_ID=sim-0001).
+ *
+ *                  The LAN control endpoint is a UDP socket on 127.0.0.1.
+ *
+ *                  Analog inputs are sampled continuously at a fixed value
+ *                  from HAL_ADC_MV_<pin>, plus uniform noise of up to
+ *                  +/- HAL_ADC_NOISE_MV when that is set.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef ARDUINO
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <random>
+#include <string>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <vector>
+#include "hal.h"
+#include "host_json.h"
+#include "sse_parser.h"
+
+// Once the input has run out, how long the firmware must report itself
+// settled before the process exits (several PWM periods, so the last latched
+// pulses are traced), and the longest it waits for that
+static const uint32_t INPUT_SETTLE_MS = 100;
+static const uint32_t INPUT_EXIT_MAX_MS = 10000;
+
+static const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+static bool trace_enabled(void) {
+  static const bool enabled = getenv("HAL_TRACE") != NULL && strcmp(getenv("HAL_TRACE"), "0") != 0;
+  return enabled;
+}
+
+// Recording to replay as the device stream, NULL if none
+static const char* replay_file(void) {
+  static const char* file = getenv("HAL_REPLAY") != NULL && getenv("HAL_REPLAY")[0] != '\0' ? getenv("HAL_REPLAY")
+                                                                                              : NULL;
+  return file;
+}
+
+// Simulated time only makes sense with a replay as input; stdin and the
+// stand-in arrive on the real clock
+static bool virtual_clock(void) {
+  static const bool enabled = replay_file() != NULL && getenv("HAL_CLOCK") != NULL &&
+                              strcmp(getenv("HAL_CLOCK"), "virtual") == 0;
+  return enabled;
+}
+
+
+// ============================================================================
+//                                VIRTUAL CLOCK
+// ============================================================================
+// Threads the HAL starts take turns: exactly one runs at a time, and the
+// rest are blocked in one of the waits below, each either queued to wake at
+// some time or waiting for a notification. When the running thread blocks,
+// the queued thread with the earliest wake-up runs next (those due at the
+// same time in the order they were queued) and the clock jumps to its
+// wake-up. A notified task, or a newly started thread, is queued at the
+// current time. Nothing ever runs concurrently, so a replay takes the same
+// course every time.
+struct SimSleeper {
+  uint64_t wake_us;
+  uint64_t order;
+  bool ready;
+};
+
+struct SimSleeperOrder {
+  bool operator()(const SimSleeper* a, const SimSleeper* b) const {
+    return a->wake_us != b->wake_us ? a->wake_us < b->wake_us : a->order < b->order;
+  }
+};
+
+static std::mutex sim_mutex;
+static std::condition_variable sim_wake;
+static std::atomic<uint64_t> sim_now_us(0);
+static std::set<SimSleeper*, SimSleeperOrder> sim_queue;
+static uint64_t sim_order = 0;
+static bool sim_running = true;   // the main thread
+
+// Caller holds sim_mutex
+static void sim_enqueue(SimSleeper* sleeper, uint64_t wake_us) {
+  sleeper->wake_us = wake_us;
+  sleeper->order = sim_order++;
+  sleeper->ready = false;
+  sim_queue.insert(sleeper);
+}
+
+// Caller holds sim_mutex
+static void sim_run_next(void) {
+  if (sim_running || sim_queue.empty()) return;
+
+  SimSleeper* next = *sim_queue.begin();
+  sim_queue.erase(sim_queue.begin());
+  if (next->wake_us > sim_now_us.load()) sim_now_us.store(next->wake_us);
+  next->ready = true;
+  sim_running = true;
+  sim_wake.notify_all();
+}
+
+// Hands the turn over and blocks until sleeper is run again. A sleeper that
+// is not queued (ex: waiting for a notification) is queued by whoever wakes
+// it; NULL never runs again.
+static void sim_block(std::unique_lock<std::mutex>& lock, SimSleeper* sleeper) {
+  sim_running = false;
+  sim_run_next();
+  sim_wake.wait(lock, [sleeper]() { return sleeper != NULL && sleeper->ready; });
+}
+
+static uint64_t clock_us(void) {
+  if (virtual_clock()) return sim_now_us.load();
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start_time).count();
+}
+
+// Sleeps until clock_us() reaches wake_us
+static void sleep_until_us(uint64_t wake_us) {
+  if (!virtual_clock()) {
+    std::this_thread::sleep_until(start_time + std::chrono::microseconds(wake_us));
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(sim_mutex);
+  SimSleeper sleeper;
+  sim_enqueue(&sleeper, wake_us);
+  sim_block(lock, &sleeper);
+}
+
+static void sleep_for_us(uint64_t us) {
+  sleep_until_us(clock_us() + us);
+}
+
+// Starts a thread. In virtual time it is queued to take its first turn now.
+static void start_thread(const std::function<void()>& body) {
+  if (!virtual_clock()) {
+    std::thread(body).detach();
+    return;
+  }
+
+  SimSleeper* start = new SimSleeper();
+  {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    sim_enqueue(start, sim_now_us.load());
+  }
+  std::thread([body, start]() {
+    {
+      std::unique_lock<std::mutex> lock(sim_mutex);
+      sim_wake.wait(lock, [start]() { return start->ready; });
+    }
+    delete start;
+    body();
+
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    sim_running = false;
+    sim_run_next();
+  }).detach();
+}
+
+// Trace lines use CLOCK_MONOTONIC so other processes on the same machine
+// (ex: tools/rtdb_loadgen) can line them up with their own timestamps. In
+// virtual time they use the virtual clock.
+static unsigned long long trace_timestamp_us(void) {
+  if (virtual_clock()) return (unsigned long long)sim_now_us.load();
+  return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// ============================================================================
+//                                GPIO / SERVOS
+// ============================================================================
+void hal_gpio_output(uint8_t pin) {
+  (void)pin;
+}
+
+void hal_gpio_write(uint8_t pin, bool high) {
+  if (trace_enabled()) printf("%llu gpio %u %u\n", trace_timestamp_us(), pin, high ? 1 : 0);
+}
+
+// Mock PWM peripheral. A thread stands in for the shared timer: at every
+// period boundary it latches the widths written since the last one, and each
+// latched change is traced as "<us> servo <channel> <pulse_us>". Writes
+// within one period collapse to the last, exactly as on the hardware, so the
+// trace is the pulse timeline the servos would see.
+static std::atomic<uint16_t> servo_pending_us[HAL_SERVO_CHANNELS];
+static uint16_t servo_latched_us[HAL_SERVO_CHANNELS];
+static std::atomic<bool> servo_attached[HAL_SERVO_CHANNELS];
+
+static void servo_period_boundaries(void) {
+  uint64_t boundary = clock_us();
+  for (;;) {
+    boundary += HAL_SERVO_PERIOD_US;
+    sleep_until_us(boundary);
+
+    for (uint8_t channel = 0; channel < HAL_SERVO_CHANNELS; channel++) {
+      if (!servo_attached[channel].load()) continue;
+      uint16_t pulse_us = servo_pending_us[channel].load();
+      if (pulse_us == servo_latched_us[channel]) continue;
+      servo_latched_us[channel] = pulse_us;
+      if (trace_enabled()) printf("%llu servo %u %u\n", trace_timestamp_us(), channel, pulse_us);
+    }
+  }
+}
+
+void hal_servo_attach(uint8_t channel, uint8_t pin) {
+  (void)pin;
+  if (channel >= HAL_SERVO_CHANNELS) return;
+
+  static std::once_flag timer_started;
+  std::call_once(timer_started, []() { start_thread(servo_period_boundaries); });
+
+  servo_pending_us[channel].store(1500);
+  servo_attached[channel].store(true);
+}
+
+void hal_servo_write_all(const uint16_t pulse_us[HAL_SERVO_CHANNELS]) {
+  for (uint8_t channel = 0; channel < HAL_SERVO_CHANNELS; channel++) servo_pending_us[channel].store(pulse_us[channel]);
+}
+
+
+// ============================================================================
+//                                     ADC
+// ============================================================================
+// Every input reads a fixed $HAL_ADC_MV_<pin> (ex: HAL_ADC_MV_34=1650, 0 if
+// unset) plus uniform noise of up to +/- $HAL_ADC_NOISE_MV. Frames are
+// produced on the sample clock, so reads block like the DMA driver does.
+static const uint32_t ADC_FULL_SCALE_MV = 3300;
+
+static uint8_t adc_input_count = 0;
+static uint16_t adc_input_raw[HAL_ADC_MAX_INPUTS];
+static int32_t adc_noise_raw = 0;
+static uint16_t adc_frame_samples = 0;
+static uint64_t adc_frame_period_us = 0;
+static uint64_t adc_next_frame_us = 0;
+
+static uint16_t mv_to_raw(uint32_t mv) {
+  uint32_t raw = (mv * HAL_ADC_MAX_RAW + ADC_FULL_SCALE_MV / 2) / ADC_FULL_SCALE_MV;
+  return raw > HAL_ADC_MAX_RAW ? HAL_ADC_MAX_RAW : (uint16_t)raw;
+}
+
+static uint32_t env_mv(const char* name) {
+  const char* value = getenv(name);
+  return value != NULL ? (uint32_t)strtoul(value, NULL, 10) : 0;
+}
+
+bool hal_adc_continuous_begin(const uint8_t* pins, uint8_t count, uint32_t sample_rate_hz, uint16_t frame_samples) {
+  if (count == 0 || count > HAL_ADC_MAX_INPUTS || frame_samples == 0 ||
+      frame_samples > HAL_ADC_MAX_FRAME_SAMPLES || sample_rate_hz == 0) return false;
+
+  for (uint8_t i = 0; i < count; i++) {
+    char name[24];
+    snprintf(name, sizeof(name), "HAL_ADC_MV_%u", pins[i]);
+    adc_input_raw[i] = mv_to_raw(env_mv(name));
+  }
+  adc_noise_raw = mv_to_raw(env_mv("HAL_ADC_NOISE_MV"));
+  adc_input_count = count;
+  adc_frame_samples = frame_samples;
+  adc_frame_period_us = (uint64_t)frame_samples * 1000000 / sample_rate_hz;
+  adc_next_frame_us = clock_us() + adc_frame_period_us;
+  return true;
+}
+
+size_t hal_adc_continuous_read(HalAdcSample* samples, size_t max_samples, uint32_t timeout_ms) {
+  if (adc_input_count == 0) {
+    sleep_for_us((uint64_t)timeout_ms * 1000);
+    return 0;
+  }
+  uint64_t now_us = clock_us();
+  if (adc_next_frame_us > now_us + (uint64_t)timeout_ms * 1000) {
+    sleep_for_us((uint64_t)timeout_ms * 1000);
+    return 0;
+  }
+  sleep_until_us(adc_next_frame_us);
+  adc_next_frame_us += adc_frame_period_us;
+
+  size_t count = max_samples < adc_frame_samples ? max_samples : adc_frame_samples;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t input = i % adc_input_count;
+    int32_t raw = adc_input_raw[input];
+    if (adc_noise_raw > 0) raw += (int32_t)(hal_random() % (2 * adc_noise_raw + 1)) - adc_noise_raw;
+    samples[i].input = input;
+    samples[i].raw = raw < 0 ? 0 : raw > HAL_ADC_MAX_RAW ? HAL_ADC_MAX_RAW : (uint16_t)raw;
+  }
+  return count;
+}
+
+uint32_t hal_adc_raw_to_mv(uint16_t raw) {
+  return ((uint32_t)raw * ADC_FULL_SCALE_MV + HAL_ADC_MAX_RAW / 2) / HAL_ADC_MAX_RAW;
+}
+
+
+// ============================================================================
+//                                    CLOCK
+// ============================================================================
+uint32_t hal_millis(void) {
+  return (uint32_t)(clock_us() / 1000);
+}
+
+uint32_t hal_micros(void) {
+  return (uint32_t)clock_us();
+}
+
+// Nanoseconds stand in for cycles on the host
+uint32_t hal_cycles(void) {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t hal_cycles_per_us(void) {
+  return 1000;
+}
+
+void hal_delay_ms(uint32_t ms) {
+  sleep_for_us((uint64_t)ms * 1000);
+}
+
+bool hal_timer_start_periodic(void (*callback)(void*), void* arg, uint32_t period_us) {
+  start_thread([callback, arg, period_us]() {
+    uint64_t next = clock_us();
+    for (;;) {
+      next += period_us;
+      sleep_until_us(next);
+      callback(arg);
+    }
+  });
+  return true;
+}
+
+uint32_t hal_random(void) {
+  static std::mutex random_mutex;
+  static std::mt19937 generator(virtual_clock() ? 1u : std::random_device{}());
+  std::lock_guard<std::mutex> lock(random_mutex);
+  return generator();
+}
+
+
+// ============================================================================
+//                                    TASKS
+// ============================================================================
+struct HostTask {
+  std::mutex mutex;
+  std::condition_variable wake;
+  uint32_t notifications = 0;
+  SimSleeper* waiting = NULL;   // blocked in hal_task_wait_notify(), virtual time only
+};
+
+static thread_local HostTask* current_task = NULL;
+
+bool hal_task_start(void (*fn)(void*), const char* name, uint32_t stack_size, uint8_t priority,
+                    int8_t core, void* arg, HalTask* handle) {
+  (void)name;
+  (void)stack_size;
+  (void)priority;
+  (void)core;
+
+  HostTask* task = new HostTask();
+  if (handle != NULL) *handle = task;
+  start_thread([fn, arg, task]() {
+    current_task = task;
+    fn(arg);
+  });
+  return true;
+}
+
+HalTask hal_task_current(void) {
+  if (current_task == NULL) current_task = new HostTask();
+  return current_task;
+}
+
+void hal_task_notify(HalTask task) {
+  if (task == NULL) return;
+  if (virtual_clock()) {
+    std::lock_guard<std::mutex> lock(sim_mutex);
+    task->notifications++;
+    if (task->waiting != NULL) {
+      sim_enqueue(task->waiting, sim_now_us.load());
+      task->waiting = NULL;
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->notifications++;
+  task->wake.notify_one();
+}
+
+void hal_task_wait_notify(void) {
+  HostTask* task = hal_task_current();
+  if (virtual_clock()) {
+    std::unique_lock<std::mutex> lock(sim_mutex);
+    if (task->notifications == 0) {
+      SimSleeper sleeper = {};
+      task->waiting = &sleeper;
+      sim_block(lock, &sleeper);
+    }
+    task->notifications = 0;
+    return;
+  }
+  std::unique_lock<std::mutex> lock(task->mutex);
+  task->wake.wait(lock, [task]() { return task->notifications > 0; });
+  task->notifications = 0;
+}
+
+void hal_task_delay_ms(uint32_t ms) {
+  sleep_for_us((uint64_t)ms * 1000);
+}
+
+void hal_task_yield_tick(void) {
+  sleep_for_us(1000);
+}
+
+void hal_task_exit(void) {
+  if (virtual_clock()) {
+    std::unique_lock<std::mutex> lock(sim_mutex);
+    sim_block(lock, NULL);
+  }
+  for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+}
+
+
+// ============================================================================
+//                                   CONSOLE
+// ============================================================================
+void hal_console_begin(uint32_t baud) {
+  (void)baud;
+  setvbuf(stdout, NULL, _IOLBF, 0);
+}
+
+void hal_console_write(const char* text, size_t length) {
+  fwrite(text, 1, length, stderr);
+}
+
+
+// ============================================================================
+//                                   STORAGE
+// ============================================================================
+// One file per key under $HAL_STORAGE_DIR. Without it nothing persists, like
+// a device with freshly erased flash, and writes are silently discarded.
+static std::string storage_file(const char* key) {
+  const char* dir = getenv("HAL_STORAGE_DIR");
+  if (dir == NULL || *dir == '\0') return std::string();
+  return std::string(dir) + "/" + key;
+}
+
+bool hal_storage_read(const char* key, void* data, size_t size) {
+  std::string file_name = storage_file(key);
+  if (file_name.empty()) return false;
+
+  FILE* file = fopen(file_name.c_str(), "rb");
+  if (file == NULL) return false;
+  size_t read = fread(data, 1, size, file);
+  bool exact = read == size && fgetc(file) == EOF;
+  fclose(file);
+  return exact;
+}
+
+bool hal_storage_write(const char* key, const void* data, size_t size) {
+  std::string file_name = storage_file(key);
+  if (file_name.empty()) return true;
+
+  FILE* file = fopen(file_name.c_str(), "wb");
+  if (file == NULL) return false;
+  bool written = fwrite(data, 1, size, file) == size;
+  return fclose(file) == 0 && written;
+}
+
+
+// ============================================================================
+//                                   NETWORK
+// ============================================================================
+// Stream goes quiet for longer than this (the RTDB sends keep-alives every
+// 30 s) and it is reported as timed out
+static const uint32_t STREAM_TIMEOUT_MS = 65000;
+
+static std::string net_error;
+
+// ------------------------------------------------------- stdin / replay input
+static bool (*input_settled_check)(void) = NULL;
+static bool input_drained = false;
+static uint32_t input_drained_ms = 0;
+static uint32_t input_settled_ms = 0;
+
+void hal_stream_set_settled_check(bool (*settled)(void)) {
+  input_settled_check = settled;
+}
+
+// Called while the input has nothing left. Exits once the firmware has been
+// settled for INPUT_SETTLE_MS (counted from when the input ran out if there
+// is no check), or when INPUT_EXIT_MAX_MS have passed since then.
+static void exit_when_settled(void) {
+  uint32_t now_ms = hal_millis();
+  if (!input_drained) {
+    input_drained = true;
+    input_drained_ms = now_ms;
+    input_settled_ms = now_ms;
+  }
+  if (input_settled_check != NULL && !input_settled_check()) input_settled_ms = now_ms;
+
+  if (now_ms - input_drained_ms >= INPUT_EXIT_MAX_MS) {
+    fprintf(stderr, "Outputs still moving %u ms after the input ran out, exiting\n", (unsigned)INPUT_EXIT_MAX_MS);
+  }
+  else if (now_ms - input_settled_ms < INPUT_SETTLE_MS) {
+    return;
+  }
+  fflush(stdout);
+  _exit(0);
+}
+
+// Walks "<path> <value>" pairs in place. A value in double quotes is text.
+static void deliver_pairs(std::string& event, HalStreamValueSink sink, HalStreamTextSink text_sink) {
+  char* save = NULL;
+  char* path = strtok_r(&event[0], " \t\r\n", &save);
+  while (path != NULL) {
+    char* value = strtok_r(NULL, " \t\r\n", &save);
+    if (value == NULL) break;
+    size_t length = strlen(value);
+    if (length >= 2 && value[0] == '"' && value[length - 1] == '"') {
+      value[length - 1] = '\0';
+      text_sink(path, value + 1);
+    }
+    else {
+      sink(path, atoi(value));
+    }
+    path = strtok_r(NULL, " \t\r\n", &save);
+  }
+}
+
+static std::mutex stdin_mutex;
+static std::deque<std::string> stdin_events;
+static bool stdin_closed = false;
+static bool stdin_started = false;
+
+static void read_stdin_events(void) {
+  char line[512];
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    if (line[0] == '#' || line[0] == '\n' || line[0] == '\0') continue;
+    std::lock_guard<std::mutex> lock(stdin_mutex);
+    stdin_events.push_back(line);
+  }
+
+  std::lock_guard<std::mutex> lock(stdin_mutex);
+  stdin_closed = true;
+}
+
+static HalStreamResult read_stdin_stream(HalStreamValueSink sink, HalStreamTextSink text_sink) {
+  std::string event;
+  {
+    std::lock_guard<std::mutex> lock(stdin_mutex);
+    if (stdin_events.empty()) {
+      if (stdin_closed) exit_when_settled();
+      return HAL_STREAM_IDLE;
+    }
+    event = stdin_events.front();
+    stdin_events.pop_front();
+  }
+
+  deliver_pairs(event, sink, text_sink);
+  return HAL_STREAM_EVENT;
+}
+
+// Recorded events, each due at an offset from the first
+struct ReplayEvent {
+  uint64_t offset_us;
+  std::string pairs;
+};
+
+static std::vector<ReplayEvent> replay_events;
+static size_t replay_next = 0;
+static uint64_t replay_start_us = 0;
+static bool replay_loaded = false;
+
+// Reads the "REC <us> <event> <path> <value>" lines of a recording (other
+// lines, ex: the rest of a console capture, are skipped). Values sharing an
+// event number are one event, due when its first value was recorded.
+static void load_replay(const char* file_name) {
+  FILE* file = fopen(file_name, "r");
+  // Retrying cannot help, and there is no other input to fall back to
+  if (file == NULL) {
+    fprintf(stderr, "%s: cannot open the recording\n", file_name);
+    exit(1);
+  }
+
+  char line[512];
+  unsigned long long first_us = 0;
+  unsigned long long previous_us = 0;
+  unsigned long long wraps = 0;
+  unsigned long event_number = 0;
+  bool dropped = false;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    const char* record = strstr(line, "REC ");
+    if (record == NULL) continue;
+    if (strncmp(record + 4, "dropped", 7) == 0) dropped = true;
+
+    unsigned long us;
+    unsigned long number;
+    int consumed = 0;
+    if (sscanf(record + 4, "%lu %lu %n", &us, &number, &consumed) != 2 || consumed == 0) continue;
+
+    // hal_micros() wraps every 71 minutes on the device
+    unsigned long long at_us = us + wraps;
+    if (!replay_events.empty() && at_us < previous_us) {
+      wraps += 1ULL << 32;
+      at_us += 1ULL << 32;
+    }
+    previous_us = at_us;
+
+    std::string pair = record + 4 + consumed;
+    while (!pair.empty() && (pair[pair.size() - 1] == '\n' || pair[pair.size() - 1] == '\r')) {
+      pair.erase(pair.size() - 1);
+    }
+    if (replay_events.empty() || number != event_number) {
+      if (replay_events.empty()) first_us = at_us;
+      ReplayEvent event = { at_us - first_us, pair };
+      replay_events.push_back(event);
+      event_number = number;
+    }
+    else {
+      replay_events.back().pairs += " " + pair;
+    }
+  }
+  fclose(file);
+
+  if (dropped) fprintf(stderr, "%s: the recorder dropped values, the replay is incomplete\n", file_name);
+}
+
+static bool open_replay_stream(void) {
+  if (!replay_loaded) {
+    load_replay(replay_file());
+    replay_loaded = true;
+    replay_start_us = clock_us();
+  }
+  return true;
+}
+
+static HalStreamResult read_replay_stream(HalStreamValueSink sink, HalStreamTextSink text_sink) {
+  if (replay_next == replay_events.size()) {
+    exit_when_settled();
+    return HAL_STREAM_IDLE;
+  }
+  ReplayEvent& event = replay_events[replay_next];
+  if (clock_us() < replay_start_us + event.offset_us) return HAL_STREAM_IDLE;
+
+  if (trace_enabled()) {
+    printf("%llu event %u %s\n", trace_timestamp_us(), (unsigned)replay_next, event.pairs.c_str());
+  }
+  replay_next++;
+  deliver_pairs(event.pairs, sink, text_sink);
+  return HAL_STREAM_EVENT;
+}
+
+// ------------------------------------------------------------------ SSE source
+// Set from RTDB_URL (ex: "http://127.0.0.1:9000") to stream from a local
+// RTDB stand-in instead of stdin
+static std::string rtdb_host;
+static uint16_t rtdb_port = 0;
+
+// Device root from hal_rtdb_begin(), prefixed to every path on the wire
+static std::string rtdb_root;
+
+static int stream_fd = -1;
+static SseParser stream_parser;
+static uint32_t stream_last_data_ms = 0;
+
+static bool use_rtdb(void) {
+  return rtdb_port != 0;
+}
+
+// Opens a TCP connection to the RTDB stand-in
+static int rtdb_connect(void) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  struct addrinfo* result = NULL;
+  std::string port = std::to_string(rtdb_port);
+  if (getaddrinfo(rtdb_host.c_str(), port.c_str(), &hints, &result) != 0 || result == NULL) {
+    net_error = "cannot resolve " + rtdb_host;
+    return -1;
+  }
+
+  int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+  if (fd >= 0 && connect(fd, result->ai_addr, result->ai_addrlen) != 0) {
+    net_error = std::string("connect: ") + strerror(errno);
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(result);
+  if (fd < 0) return -1;
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+// Converts a path under the device root to its REST resource
+// (ex: "/a/b" -> "/devices/host/a/b/.json")
+static std::string rest_resource(const std::string& path) {
+  std::string resource = rtdb_root + path;
+  while (!resource.empty() && resource[resource.size() - 1] == '/') resource.erase(resource.size() - 1);
+  return resource + "/.json";
+}
+
+static bool open_rtdb_stream(const char* path, const char* const* watched_paths, uint8_t watched_count) {
+  if (stream_fd >= 0) close(stream_fd);
+  stream_fd = rtdb_connect();
+  // Values are keyed relative to the stream path, as the RTDB sends them
+  stream_parser.begin("/", watched_paths, watched_count);
+  stream_last_data_ms = hal_millis();
+  if (stream_fd < 0) return false;
+
+  std::string request = "GET " + rest_resource(path) + " HTTP/1.1\r\nHost: " + rtdb_host +
+                        "\r\nAccept: text/event-stream\r\n\r\n";
+  if (send(stream_fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) {
+    net_error = "stream request failed";
+    close(stream_fd);
+    stream_fd = -1;
+    return false;
+  }
+  fcntl(stream_fd, F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+static HalStreamResult read_rtdb_stream(HalStreamValueSink sink, HalStreamTextSink text_sink) {
+  if (stream_fd < 0) return HAL_STREAM_TIMEOUT;
+
+  // Events already buffered go first, one per call
+  SseStatus status = stream_parser.parse(sink, text_sink);
+  if (status == SSE_MORE) {
+    size_t space;
+    char* at = stream_parser.receive_space(space);
+    ssize_t n = recv(stream_fd, at, space, 0);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+      net_error = "stream closed";
+      close(stream_fd);
+      stream_fd = -1;
+      return HAL_STREAM_TIMEOUT;
+    }
+    if (n > 0) {
+      stream_parser.received((size_t)n);
+      stream_last_data_ms = hal_millis();
+      status = stream_parser.parse(sink, text_sink);
+    }
+    else if (hal_millis() - stream_last_data_ms > STREAM_TIMEOUT_MS) {
+      return HAL_STREAM_TIMEOUT;
+    }
+  }
+
+  switch (status) {
+    case SSE_EVENT:
+      return HAL_STREAM_EVENT;
+    case SSE_CLOSED:
+      return HAL_STREAM_TIMEOUT;
+    case SSE_REDIRECT:
+      net_error = std::string("redirected to ") + stream_parser.location();
+      return HAL_STREAM_ERROR;
+    case SSE_HTTP_ERROR:
+      net_error = "HTTP " + std::to_string(stream_parser.http_status());
+      return HAL_STREAM_ERROR;
+    default:
+      return HAL_STREAM_IDLE;
+  }
+}
+
+// --------------------------------------------------------------------- HAL API
+void hal_wifi_begin(const char* ssid, const char* password) {
+  (void)ssid;
+  (void)password;
+}
+
+bool hal_wifi_connected(void) {
+  return true;
+}
+
+void hal_wifi_reconnect(void) {
+}
+
+void hal_chip_id(char* buffer, size_t size) {
+  const char* id = getenv("HAL_CHIP_ID");
+  snprintf(buffer, size, "%s", id != NULL && id[0] != '\0' ? id : "host");
+}
+
+void hal_rtdb_begin(const char* database_url, const char* root) {
+  (void)database_url;
+  rtdb_root = root;
+  while (!rtdb_root.empty() && rtdb_root[rtdb_root.size() - 1] == '/') rtdb_root.erase(rtdb_root.size() - 1);
+
+  // The real database URL is replaced by the local stand-in, if any
+  const char* url = getenv("RTDB_URL");
+  if (url == NULL) return;
+
+  std::string address = url;
+  size_t scheme = address.find("://");
+  if (scheme != std::string::npos) address.erase(0, scheme + 3);
+  address = address.substr(0, address.find('/'));
+  size_t colon = address.find(':');
+  rtdb_host = address.substr(0, colon);
+  rtdb_port = colon == std::string::npos ? 80 : (uint16_t)atoi(address.c_str() + colon + 1);
+}
+
+bool hal_rtdb_ready(void) {
+  return true;
+}
+
+void hal_rtdb_reconnect(void) {
+}
+
+bool hal_stream_begin(const char* path, const char* const* watched_paths, uint8_t watched_count) {
+  if (replay_file() != NULL) return open_replay_stream();
+  if (use_rtdb()) return open_rtdb_stream(path, watched_paths, watched_count);
+
+  if (!stdin_started) {
+    stdin_started = true;
+    std::thread(read_stdin_events).detach();
+  }
+  return true;
+}
+
+HalStreamResult hal_stream_read(HalStreamValueSink sink, HalStreamTextSink text_sink) {
+  if (replay_file() != NULL) return read_replay_stream(sink, text_sink);
+  return use_rtdb() ? read_rtdb_stream(sink, text_sink) : read_stdin_stream(sink, text_sink);
+}
+
+// One request on a fresh connection, checked for a 200 reply
+static bool rtdb_write(const char* method, const char* path, const char* json) {
+  // Without a stand-in (or while replaying) there is nowhere to write to
+  if (!use_rtdb() || replay_file() != NULL) return true;
+
+  int fd = rtdb_connect();
+  if (fd < 0) return false;
+
+  std::string body = json;
+  std::string request = std::string(method) + " " + rest_resource(path) + " HTTP/1.1\r\nHost: " + rtdb_host +
+                        "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+                        "\r\nConnection: close\r\n\r\n" + body;
+  bool sent = send(fd, request.data(), request.size(), MSG_NOSIGNAL) == (ssize_t)request.size();
+
+  char status[32] = {};
+  bool ok = sent && recv(fd, status, sizeof(status) - 1, 0) > 0 && strncmp(status, "HTTP/1.1 200", 12) == 0;
+  close(fd);
+  if (!ok) net_error = "write to " + std::string(path) + " failed";
+  return ok;
+}
+
+bool hal_rtdb_set_json(const char* path, const char* json) {
+  return rtdb_write("PUT", path, json);
+}
+
+bool hal_rtdb_update_json(const char* path, const char* json) {
+  return rtdb_write("PATCH", path, json);
+}
+
+bool hal_wifi_local_ip(char* buffer, size_t size) {
+  snprintf(buffer, size, "127.0.0.1");
+  return true;
+}
+
+static int lan_fd = -1;
+
+uint16_t hal_lan_begin(uint16_t port) {
+  lan_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (lan_fd < 0) return 0;
+  fcntl(lan_fd, F_SETFL, fcntl(lan_fd, F_GETFL) | O_NONBLOCK);
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  // Several host instances may run side by side, so fall back to any port
+  if (bind(lan_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    addr.sin_port = 0;
+    if (bind(lan_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+      close(lan_fd);
+      lan_fd = -1;
+      return 0;
+    }
+  }
+
+  socklen_t length = sizeof(addr);
+  getsockname(lan_fd, (struct sockaddr*)&addr, &length);
+  return ntohs(addr.sin_port);
+}
+
+size_t hal_lan_read(uint8_t* buffer, size_t size) {
+  if (lan_fd < 0) return 0;
+  uint8_t message[HAL_LAN_MAX_MESSAGE + 1];
+  ssize_t length = recv(lan_fd, message, sizeof(message), 0);
+  if (length <= 0 || (size_t)length > HAL_LAN_MAX_MESSAGE || (size_t)length > size) return 0;
+  memcpy(buffer, message, (size_t)length);
+  return (size_t)length;
+}
+
+const char* hal_net_error(void) {
+  return net_error.c_str();
+}
+
+uint32_t hal_free_heap(void) {
+  return 0;
+}
+
+#endif
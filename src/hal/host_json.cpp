@@ -0,0 +1,155 @@
+/**
+ * Description:     Minimal JSON flattening for the host build and tools
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef ARDUINO
+
+#include <math.h>
+#include <stdlib.h>
+#include "host_json.h"
+
+namespace {
+
+class Flattener {
+public:
+  Flattener(const std::string& text, const JsonLeafVisitor& visitor) : json(text), pos(0), visit(visitor) {}
+
+  bool run(const std::string& base_path) {
+    if (!value(base_path)) return false;
+    skip_space();
+    return pos == json.size();
+  }
+
+private:
+  const std::string& json;
+  size_t pos;
+  const JsonLeafVisitor& visit;
+
+  void skip_space(void) {
+    while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\r' || json[pos] == '\n')) pos++;
+  }
+
+  // Reads a string token, returning its raw text including quotes
+  bool string_token(std::string& raw) {
+    size_t start = pos;
+    if (pos >= json.size() || json[pos] != '"') return false;
+    for (pos++; pos < json.size(); pos++) {
+      if (json[pos] == '\\') pos++;
+      else if (json[pos] == '"') {
+        pos++;
+        raw = json.substr(start, pos - start);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool value(const std::string& path) {
+    skip_space();
+    if (pos >= json.size()) return false;
+
+    if (json[pos] == '{') return object(path);
+    if (json[pos] == '[') return array(path);
+
+    std::string raw;
+    if (json[pos] == '"') {
+      if (!string_token(raw)) return false;
+    }
+    else {
+      size_t start = pos;
+      while (pos < json.size() && json[pos] != ',' && json[pos] != '}' && json[pos] != ']' &&
+             json[pos] != ' ' && json[pos] != '\r' && json[pos] != '\n' && json[pos] != '\t') pos++;
+      raw = json.substr(start, pos - start);
+      if (raw.empty()) return false;
+    }
+    visit(path, raw);
+    return true;
+  }
+
+  bool object(const std::string& path) {
+    pos++;
+    skip_space();
+    if (pos < json.size() && json[pos] == '}') {
+      pos++;
+      visit(path, "null");
+      return true;
+    }
+    for (;;) {
+      skip_space();
+      std::string raw_key;
+      if (!string_token(raw_key)) return false;
+      skip_space();
+      if (pos >= json.size() || json[pos] != ':') return false;
+      pos++;
+      if (!value(json_join_path(path, raw_key.substr(1, raw_key.size() - 2)))) return false;
+      skip_space();
+      if (pos >= json.size()) return false;
+      if (json[pos] == ',') { pos++; continue; }
+      if (json[pos] == '}') { pos++; return true; }
+      return false;
+    }
+  }
+
+  // RTDB stores arrays as objects keyed by index
+  bool array(const std::string& path) {
+    pos++;
+    skip_space();
+    if (pos < json.size() && json[pos] == ']') {
+      pos++;
+      visit(path, "null");
+      return true;
+    }
+    for (unsigned index = 0;; index++) {
+      if (!value(json_join_path(path, std::to_string(index)))) return false;
+      skip_space();
+      if (pos >= json.size()) return false;
+      if (json[pos] == ',') { pos++; continue; }
+      if (json[pos] == ']') { pos++; return true; }
+      return false;
+    }
+  }
+};
+
+}
+
+bool json_flatten(const std::string& json, const std::string& base_path, const JsonLeafVisitor& visit) {
+  Flattener flattener(json, visit);
+  return flattener.run(base_path.empty() ? "/" : base_path);
+}
+
+std::string json_join_path(const std::string& base_path, const std::string& key) {
+  std::string path = base_path;
+  while (!path.empty() && path[path.size() - 1] == '/') path.erase(path.size() - 1);
+
+  size_t start = 0;
+  while (start < key.size() && key[start] == '/') start++;
+  size_t end = key.size();
+  while (end > start && key[end - 1] == '/') end--;
+
+  if (start == end) return path.empty() ? "/" : path;
+  return path + "/" + key.substr(start, end - start);
+}
+
+bool json_scalar_to_int(const std::string& value, int& result) {
+  if (value == "true") { result = 1; return true; }
+  if (value == "false") { result = 0; return true; }
+  if (value.empty() || value[0] == '"' || value == "null") return false;
+
+  char* end = NULL;
+  double number = strtod(value.c_str(), &end);
+  if (end == value.c_str()) return false;
+  result = (int)lround(number);
+  return true;
+}
+
+bool json_scalar_to_string(const std::string& value, std::string& result) {
+  if (value.size() < 2 || value[0] != '"' || value[value.size() - 1] != '"') return false;
+  if (value.find('\\') != std::string::npos) return false;
+  result = value.substr(1, value.size() - 2);
+  return true;
+}
+
+#endif
@@ -0,0 +1,45 @@
+/**
+ * Description:     Minimal JSON helpers for the Linux host build and the host
+ *                  tools (RTDB stand-in server, load generator).
+ *
+ *                  RTDB payloads are trees whose leaves are scalars, so the
+ *                  only operation needed is flattening a document into
+ *                  (absolute path, raw scalar text) pairs. Keys containing
+ *                  '/' (multi-path updates) are joined into the path as-is.
+ *
+ *                  Host only; the firmware never links this.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef HOST_JSON_H
+#define HOST_JSON_H
+
+#ifndef ARDUINO
+
+#include <functional>
+#include <string>
+
+// Receives each leaf as its absolute path and raw JSON text (ex: "120",
+// "true", "null", "\"text\""). An empty object is reported as "null".
+typedef std::function<void(const std::string& path, const std::string& value)> JsonLeafVisitor;
+
+// Flattens json into leaves rooted at base_path ("/" or "/a/b").
+// Returns false if json is malformed; leaves before the error are reported.
+bool json_flatten(const std::string& json, const std::string& base_path, const JsonLeafVisitor& visit);
+
+// Joins an RTDB path and a relative key, normalizing slashes
+std::string json_join_path(const std::string& base_path, const std::string& key);
+
+// Converts a raw scalar to an int the way the firmware reads it. Returns
+// false for null, strings and objects.
+bool json_scalar_to_int(const std::string& value, int& result);
+
+// Unquotes a raw string scalar. Returns false for anything else, and for
+// strings with escapes (the firmware only reads plain base64 text).
+bool json_scalar_to_string(const std::string& value, std::string& result);
+
+#endif
+
+#endif
@@ -0,0 +1,20 @@
+/**
+ * Description:     Program entry point for the Linux host build. Runs the
+ *                  Arduino-style setup() and loop() the same way the ESP32
+ *                  core does.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef ARDUINO
+
+void setup(void);
+void loop(void);
+
+int main(void) {
+  setup();
+  for (;;) loop();
+}
+
+#endif
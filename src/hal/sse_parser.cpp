@@ -0,0 +1,570 @@
+/**
+ * Description:     Incremental RTDB stream parser
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sse_parser.h"
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+static char lowercase(char c) {
+  return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Characters of numbers, true, false and null
+static bool is_literal_char(char c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '-' || c == '+' || c == '.' || c == 'E';
+}
+
+SseParser::SseParser() {
+  begin("/", NULL, 0);
+}
+
+void SseParser::begin(const char* stream, const char* const* watched_paths, uint8_t count) {
+  buffer_length = 0;
+  watched = watched_paths;
+  watched_count = count;
+
+  // The root is kept as "" so children join as "/key"
+  size_t length = strlen(stream);
+  while (length > 0 && stream[length - 1] == '/') length--;
+  if (length >= sizeof(stream_path)) length = sizeof(stream_path) - 1;
+  memcpy(stream_path, stream, length);
+  stream_path[length] = '\0';
+
+  http_state = HTTP_STATUS_LINE;
+  status_code = 0;
+  header = HEADER_OTHER;
+  chunked = false;
+  chunk_remaining = 0;
+  location_text[0] = '\0';
+  location_length = 0;
+  token_length = 0;
+  token_overflow = false;
+  reset_line();
+  reset_event();
+}
+
+char* SseParser::receive_space(size_t& size) {
+  size = sizeof(buffer) - buffer_length;
+  return buffer + buffer_length;
+}
+
+void SseParser::received(size_t length) {
+  buffer_length += length;
+}
+
+SseStatus SseParser::parse(HalStreamValueSink sink, HalStreamTextSink text) {
+  value_sink = sink;
+  text_sink = text;
+
+  SseStatus status = SSE_MORE;
+  size_t used = 0;
+  while (used < buffer_length && status == SSE_MORE) status = http_byte(buffer[used++]);
+
+  memmove(buffer, buffer + used, buffer_length - used);
+  buffer_length -= used;
+  return status;
+}
+
+void SseParser::token_push(char c) {
+  if (token_length < sizeof(token) - 1) token[token_length++] = c;
+  else token_overflow = true;
+}
+
+
+// ============================================================================
+//                                 HTTP LAYER
+// ============================================================================
+SseStatus SseParser::http_byte(char c) {
+  switch (http_state) {
+    case HTTP_BODY:
+      return sse_byte(c);
+
+    case HTTP_CHUNK_DATA:
+      if (--chunk_remaining == 0) http_state = HTTP_CHUNK_END;
+      return sse_byte(c);
+
+    case HTTP_CHUNK_END:
+      // CRLF after the chunk data
+      if (c == '\n') http_state = HTTP_CHUNK_SIZE;
+      return SSE_MORE;
+
+    case HTTP_CHUNK_SIZE: {
+      int digit = hex_value(c);
+      if (digit >= 0) {
+        if (chunk_remaining < 0x10000000) chunk_remaining = chunk_remaining * 16 + digit;
+        return SSE_MORE;
+      }
+      if (c == '\n') return chunk_size_done();
+      if (c != '\r') http_state = HTTP_CHUNK_EXTENSION;
+      return SSE_MORE;
+    }
+
+    case HTTP_CHUNK_EXTENSION:
+      return c == '\n' ? chunk_size_done() : SSE_MORE;
+
+    case HTTP_STATUS_LINE:
+      // "HTTP/1.1 200 OK"
+      if (c == '\n') {
+        token[token_length] = '\0';
+        const char* space = strchr(token, ' ');
+        status_code = space != NULL ? atoi(space + 1) : 0;
+        token_length = 0;
+        http_state = HTTP_HEADER_NAME;
+      }
+      else if (c != '\r') {
+        token_push(c);
+      }
+      return SSE_MORE;
+
+    case HTTP_HEADER_NAME:
+      if (c == '\r') return SSE_MORE;
+      if (c == '\n') {
+        // A blank line ends the head
+        if (token_length == 0) return head_done();
+        token_length = 0;
+        return SSE_MORE;
+      }
+      if (c == ':') {
+        token[token_length] = '\0';
+        header = strcmp(token, "location") == 0 ? HEADER_LOCATION
+               : strcmp(token, "transfer-encoding") == 0 ? HEADER_TRANSFER_ENCODING
+               : HEADER_OTHER;
+        token_length = 0;
+        http_state = HTTP_HEADER_VALUE;
+        return SSE_MORE;
+      }
+      token_push(lowercase(c));
+      return SSE_MORE;
+
+    case HTTP_HEADER_VALUE:
+      if (c == '\r') return SSE_MORE;
+      if (c == '\n') {
+        header_value_done();
+        http_state = HTTP_HEADER_NAME;
+        return SSE_MORE;
+      }
+      if (header == HEADER_LOCATION) {
+        if ((location_length > 0 || c != ' ') && location_length < sizeof(location_text) - 1) {
+          location_text[location_length++] = c;
+          location_text[location_length] = '\0';
+        }
+      }
+      else if (header == HEADER_TRANSFER_ENCODING) {
+        token_push(lowercase(c));
+      }
+      return SSE_MORE;
+
+    case HTTP_DONE:
+      return SSE_MORE;
+  }
+  return SSE_MORE;
+}
+
+void SseParser::header_value_done(void) {
+  if (header == HEADER_TRANSFER_ENCODING) {
+    token[token_length] = '\0';
+    chunked = strstr(token, "chunked") != NULL;
+  }
+  header = HEADER_OTHER;
+  token_length = 0;
+  token_overflow = false;
+}
+
+SseStatus SseParser::head_done(void) {
+  if (status_code >= 300 && status_code < 400 && location_length > 0) {
+    http_state = HTTP_DONE;
+    return SSE_REDIRECT;
+  }
+  if (status_code != 200) {
+    http_state = HTTP_DONE;
+    return SSE_HTTP_ERROR;
+  }
+  http_state = chunked ? HTTP_CHUNK_SIZE : HTTP_BODY;
+  chunk_remaining = 0;
+  return SSE_MORE;
+}
+
+SseStatus SseParser::chunk_size_done(void) {
+  // A zero-length chunk ends the response
+  if (chunk_remaining == 0) {
+    http_state = HTTP_DONE;
+    return SSE_CLOSED;
+  }
+  http_state = HTTP_CHUNK_DATA;
+  return SSE_MORE;
+}
+
+
+// ============================================================================
+//                                 SSE LAYER
+// ============================================================================
+// Lines are "<field>: <value>" and a blank line ends the event. Only "event"
+// and "data" matter; comments (":...") and other fields are ignored.
+SseStatus SseParser::sse_byte(char c) {
+  if (c == '\r') return SSE_MORE;
+  if (c == '\n') {
+    if (line_state == LINE_FIELD && field_length == 0) return event_done();
+    line_done();
+    return SSE_MORE;
+  }
+
+  switch (line_state) {
+    case LINE_FIELD:
+      if (c == ':') {
+        token[token_length] = '\0';
+        field = token_overflow ? FIELD_OTHER
+              : strcmp(token, "event") == 0 ? FIELD_EVENT
+              : strcmp(token, "data") == 0 ? FIELD_DATA
+              : FIELD_OTHER;
+        token_length = 0;
+        token_overflow = false;
+        line_state = LINE_VALUE_START;
+        return SSE_MORE;
+      }
+      field_length++;
+      token_push(c);
+      return SSE_MORE;
+
+    case LINE_VALUE_START:
+      line_state = LINE_VALUE;
+      // One space after the colon is not part of the value
+      if (c == ' ') return SSE_MORE;
+      // fall through
+    case LINE_VALUE:
+      if (field == FIELD_EVENT) token_push(c);
+      else if (field == FIELD_DATA && (event_kind == EVENT_PUT || event_kind == EVENT_PATCH)) json_byte(c);
+      return SSE_MORE;
+  }
+  return SSE_MORE;
+}
+
+void SseParser::line_done(void) {
+  if (line_state != LINE_FIELD && field == FIELD_EVENT) {
+    token[token_length] = '\0';
+    event_kind = token_overflow ? EVENT_OTHER
+               : strcmp(token, "put") == 0 ? EVENT_PUT
+               : strcmp(token, "patch") == 0 ? EVENT_PATCH
+               : strcmp(token, "cancel") == 0 || strcmp(token, "auth_revoked") == 0 ? EVENT_CLOSE
+               : EVENT_OTHER;
+    json_state = JSON_START;
+  }
+  // Lines of one data field are joined with a newline, which JSON skips
+  else if (line_state != LINE_FIELD && field == FIELD_DATA &&
+           (event_kind == EVENT_PUT || event_kind == EVENT_PATCH)) {
+    json_byte('\n');
+  }
+  if (line_state != LINE_FIELD && field != FIELD_OTHER) event_has_fields = true;
+  reset_line();
+}
+
+SseStatus SseParser::event_done(void) {
+  SseStatus status = SSE_MORE;
+  if (event_kind == EVENT_PUT || event_kind == EVENT_PATCH) status = SSE_EVENT;
+  else if (event_kind == EVENT_CLOSE) status = SSE_CLOSED;
+  else if (event_has_fields) status = SSE_KEEP_ALIVE;
+
+  reset_line();
+  reset_event();
+  return status;
+}
+
+void SseParser::reset_line(void) {
+  line_state = LINE_FIELD;
+  field = FIELD_OTHER;
+  field_length = 0;
+  token_length = 0;
+  token_overflow = false;
+}
+
+void SseParser::reset_event(void) {
+  event_kind = EVENT_NONE;
+  event_has_fields = false;
+  json_state = JSON_START;
+  depth = 0;
+}
+
+
+// ============================================================================
+//                                 JSON LAYER
+// ============================================================================
+void SseParser::json_byte(char c) {
+  if (json_state == JSON_STRING) {
+    string_byte(c);
+    return;
+  }
+  if (json_state == JSON_LITERAL) {
+    if (is_literal_char(c)) {
+      token_push(c);
+      return;
+    }
+    finish_scalar(false);
+  }
+  if (json_state == JSON_ERROR || is_space(c)) return;
+
+  switch (json_state) {
+    case JSON_START:
+      if (c != '{') {
+        json_state = JSON_ERROR;
+        return;
+      }
+      // The event itself: {"path": ..., "data": ...}
+      base_length = (uint8_t)strlen(stream_path);
+      base_too_long = false;
+      memcpy(path, stream_path, base_length);
+      path_length = base_length;
+      role = ROLE_SKIP;
+      push_container(false);
+      return;
+
+    case JSON_VALUE:
+      begin_value(c);
+      return;
+
+    case JSON_KEY:
+      if (c == '"') {
+        json_state = JSON_STRING;
+        string_is_key = true;
+        escape = 0;
+        token_length = 0;
+        token_overflow = false;
+      }
+      else if (c == '}') {
+        pop_container();
+      }
+      else {
+        json_state = JSON_ERROR;
+      }
+      return;
+
+    case JSON_COLON:
+      json_state = c == ':' ? JSON_VALUE : JSON_ERROR;
+      return;
+
+    case JSON_AFTER_VALUE: {
+      Frame& top = stack[depth - 1];
+      if (c == ',') {
+        if (top.array) top.index++;
+        json_state = top.array ? JSON_VALUE : JSON_KEY;
+      }
+      else if (c == (top.array ? ']' : '}')) {
+        pop_container();
+      }
+      else {
+        json_state = JSON_ERROR;
+      }
+      return;
+    }
+
+    // Anything after the event object is malformed, but there is nothing
+    // left to deliver either
+    case JSON_DONE:
+      json_state = JSON_ERROR;
+      return;
+
+    default:
+      return;
+  }
+}
+
+void SseParser::string_byte(char c) {
+  if (escape == 1) {
+    escape = 0;
+    switch (c) {
+      case 'n': token_push('\n'); break;
+      case 't': token_push('\t'); break;
+      case 'r': token_push('\r'); break;
+      case 'b': token_push('\b'); break;
+      case 'f': token_push('\f'); break;
+      case 'u': escape = 2; unicode = 0; break;
+      default: token_push(c); break;
+    }
+    return;
+  }
+  if (escape >= 2) {
+    int digit = hex_value(c);
+    if (digit < 0) {
+      json_state = JSON_ERROR;
+      return;
+    }
+    unicode = (uint16_t)(unicode << 4 | digit);
+    // Watched paths and values are ASCII, so anything else only needs a stand-in
+    if (++escape == 6) {
+      escape = 0;
+      token_push(unicode < 0x80 ? (char)unicode : '?');
+    }
+    return;
+  }
+  if (c == '\\') {
+    escape = 1;
+    return;
+  }
+  if (c != '"') {
+    token_push(c);
+    return;
+  }
+
+  if (!string_is_key) {
+    finish_scalar(true);
+    return;
+  }
+  if (token_overflow) role = ROLE_SKIP;
+  else enter_child(token, token_length);
+  json_state = JSON_COLON;
+}
+
+void SseParser::begin_value(char c) {
+  Frame& top = stack[depth - 1];
+  if (top.array) {
+    if (c == ']') {
+      pop_container();
+      return;
+    }
+    // Elements are keyed by index, as the RTDB stores arrays
+    char key[6];
+    int length = snprintf(key, sizeof(key), "%u", (unsigned)top.index);
+    enter_child(key, (size_t)length);
+  }
+
+  if (c == '{' || c == '[') {
+    push_container(c == '[');
+    return;
+  }
+  token_length = 0;
+  token_overflow = false;
+  if (c == '"') {
+    json_state = JSON_STRING;
+    string_is_key = false;
+    escape = 0;
+  }
+  else if (is_literal_char(c)) {
+    json_state = JSON_LITERAL;
+    token_push(c);
+  }
+  else {
+    json_state = JSON_ERROR;
+  }
+}
+
+// Sets path and role for the value under key in the innermost container
+void SseParser::enter_child(const char* key, size_t key_length) {
+  // Directly inside the event object
+  if (depth == 1) {
+    if (key_length == 4 && memcmp(key, "path", 4) == 0) {
+      role = ROLE_EVENT_PATH;
+    }
+    else if (key_length == 4 && memcmp(key, "data", 4) == 0 && !base_too_long) {
+      role = ROLE_DATA;
+      path_length = base_length;
+    }
+    else {
+      role = ROLE_SKIP;
+    }
+    return;
+  }
+
+  const Frame& parent = stack[depth - 1];
+  role = ROLE_SKIP;
+  if (!parent.watched || parent.path_length + 1 + key_length >= sizeof(path)) return;
+
+  // Patch keys may hold several levels ("a/b"), which join the same way
+  path_length = parent.path_length;
+  path[path_length++] = '/';
+  memcpy(path + path_length, key, key_length);
+  path_length = (uint8_t)(path_length + key_length);
+  role = ROLE_DATA;
+}
+
+void SseParser::push_container(bool array) {
+  if (depth == SSE_MAX_DEPTH) {
+    json_state = JSON_ERROR;
+    return;
+  }
+  Frame& frame = stack[depth++];
+  frame.array = array;
+  frame.index = 0;
+  frame.path_length = path_length;
+  frame.watched = role == ROLE_DATA && watched_through();
+  json_state = array ? JSON_VALUE : JSON_KEY;
+}
+
+void SseParser::pop_container(void) {
+  depth--;
+  json_state = depth == 0 ? JSON_DONE : JSON_AFTER_VALUE;
+}
+
+void SseParser::finish_scalar(bool is_string) {
+  json_state = JSON_AFTER_VALUE;
+  if (token_overflow) return;
+  token[token_length] = '\0';
+
+  if (role == ROLE_EVENT_PATH) {
+    if (is_string) set_base_path(token);
+    return;
+  }
+  if (role != ROLE_DATA) return;
+
+  path[path_length] = '\0';
+  const char* leaf = path_length == 0 ? "/" : path;
+  if (!watched_exactly(leaf)) return;
+
+  if (is_string) {
+    text_sink(leaf, token);
+    return;
+  }
+  if (strcmp(token, "true") == 0) {
+    value_sink(leaf, 1);
+    return;
+  }
+  if (strcmp(token, "false") == 0) {
+    value_sink(leaf, 0);
+    return;
+  }
+  // Numbers are rounded like the RTDB client's intData(); null is a delete
+  char* end = NULL;
+  double number = strtod(token, &end);
+  if (end != token && *end == '\0') value_sink(leaf, (int)lround(number));
+}
+
+void SseParser::set_base_path(const char* event_path) {
+  size_t stream_length = strlen(stream_path);
+  size_t length = strlen(event_path);
+  while (length > 0 && event_path[length - 1] == '/') length--;
+
+  base_too_long = stream_length + length >= sizeof(path);
+  if (base_too_long) return;
+  memcpy(path + stream_length, event_path, length);
+  base_length = (uint8_t)(stream_length + length);
+  path_length = base_length;
+}
+
+// True if a watched path lies strictly below the current path
+bool SseParser::watched_through(void) const {
+  for (uint8_t i = 0; i < watched_count; i++) {
+    if (strncmp(watched[i], path, path_length) == 0 && watched[i][path_length] == '/') return true;
+  }
+  return false;
+}
+
+bool SseParser::watched_exactly(const char* leaf) const {
+  for (uint8_t i = 0; i < watched_count; i++) {
+    if (strcmp(watched[i], leaf) == 0) return true;
+  }
+  return false;
+}
@@ -0,0 +1,162 @@
+/**
+ * Description:     Incremental parser for the RTDB's streaming response.
+ *
+ *                  Takes the bytes of a streaming REST response as they
+ *                  arrive, split anywhere, and delivers the leaves of each
+ *                  "put" and "patch" event straight to the stream sinks. It
+ *                  never builds a document or allocates. The HTTP head, the
+ *                  chunked framing, the SSE fields and the JSON are each a
+ *                  small state machine fed one byte at a time. Only the
+ *                  receive buffer, the current path and one token are kept,
+ *                  in fixed arrays.
+ *
+ *                  An event's data is {"path": p, "data": d}. Each scalar
+ *                  leaf of d is delivered under the stream path joined with
+ *                  p and the leaf's keys, but only when that path is one of
+ *                  the watched paths. Subtrees that no watched path runs
+ *                  through are read without building their paths. The RTDB
+ *                  always sends "path" first; data that arrives before it is
+ *                  read against the stream path itself.
+ *
+ *                  A string longer than SSE_MAX_TOKEN or a path longer than
+ *                  SSE_MAX_PATH cannot be a watched value, so it is skipped
+ *                  instead of stored. Malformed JSON drops the rest of its
+ *                  event; parsing resumes at the next one.
+ *
+ *                  Shared by both HAL backends. One parser per stream, used
+ *                  by one task.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef SSE_PARSER_H
+#define SSE_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hal.h"
+
+const size_t SSE_RECEIVE_BUFFER_SIZE = 512;
+const size_t SSE_MAX_PATH = 96;
+const size_t SSE_MAX_TOKEN = 48;
+const size_t SSE_MAX_LOCATION = 256;
+const uint8_t SSE_MAX_DEPTH = 12;
+
+// Result of SseParser::parse()
+enum SseStatus : uint8_t {
+  SSE_MORE = 0,       // every buffered byte was used and no event finished
+  SSE_EVENT,          // a put or patch finished; its leaves were delivered
+  SSE_KEEP_ALIVE,     // any other event finished (keep-alive, unknown types)
+  SSE_CLOSED,         // the server ended the stream (cancel, auth_revoked, last chunk)
+  SSE_REDIRECT,       // the response is a redirect to location()
+  SSE_HTTP_ERROR      // the response status is not 200, see http_status()
+};
+
+class SseParser {
+public:
+  SseParser();
+
+  // Start on a new response for a stream opened on stream_path. watched_paths
+  // must stay valid while the parser is in use.
+  void begin(const char* stream_path, const char* const* watched_paths, uint8_t watched_count);
+
+  // Free space at the end of the receive buffer, to read the socket into
+  char* receive_space(size_t& size);
+
+  // Mark length bytes of receive_space() as filled
+  void received(size_t length);
+
+  // Parse buffered bytes up to the end of the next event. After
+  // SSE_CLOSED, SSE_REDIRECT or SSE_HTTP_ERROR, call begin() on a new
+  // connection before parsing again.
+  SseStatus parse(HalStreamValueSink sink, HalStreamTextSink text_sink);
+
+  int http_status() const { return status_code; }
+
+  // Target of the last redirect (ex: "https://host/.json?ns=db")
+  const char* location() const { return location_text; }
+
+private:
+  enum HttpState : uint8_t { HTTP_STATUS_LINE, HTTP_HEADER_NAME, HTTP_HEADER_VALUE, HTTP_BODY,
+                             HTTP_CHUNK_SIZE, HTTP_CHUNK_EXTENSION, HTTP_CHUNK_DATA, HTTP_CHUNK_END, HTTP_DONE };
+  enum Header : uint8_t { HEADER_OTHER, HEADER_LOCATION, HEADER_TRANSFER_ENCODING };
+  enum LineState : uint8_t { LINE_FIELD, LINE_VALUE_START, LINE_VALUE };
+  enum Field : uint8_t { FIELD_OTHER, FIELD_EVENT, FIELD_DATA };
+  enum EventKind : uint8_t { EVENT_NONE, EVENT_PUT, EVENT_PATCH, EVENT_CLOSE, EVENT_OTHER };
+  enum JsonState : uint8_t { JSON_START, JSON_VALUE, JSON_KEY, JSON_COLON, JSON_AFTER_VALUE, JSON_STRING,
+                             JSON_LITERAL, JSON_DONE, JSON_ERROR };
+  enum Role : uint8_t { ROLE_SKIP, ROLE_EVENT_PATH, ROLE_DATA };
+
+  struct Frame {
+    bool array;
+    bool watched;           // some watched path runs through this container
+    uint8_t path_length;    // length of the container's own path
+    uint16_t index;         // next element, for arrays
+  };
+
+  SseStatus http_byte(char c);
+  void header_value_done(void);
+  SseStatus head_done(void);
+  SseStatus chunk_size_done(void);
+  SseStatus sse_byte(char c);
+  void line_done(void);
+  SseStatus event_done(void);
+  void reset_line(void);
+  void reset_event(void);
+  void json_byte(char c);
+  void string_byte(char c);
+  void begin_value(char c);
+  void enter_child(const char* key, size_t key_length);
+  void push_container(bool array);
+  void pop_container(void);
+  void finish_scalar(bool is_string);
+  void token_push(char c);
+  void set_base_path(const char* event_path);
+  bool watched_through(void) const;
+  bool watched_exactly(const char* path) const;
+
+  // Receive buffer
+  char buffer[SSE_RECEIVE_BUFFER_SIZE];
+  size_t buffer_length;
+
+  HalStreamValueSink value_sink;
+  HalStreamTextSink text_sink;
+  const char* const* watched;
+  uint8_t watched_count;
+  char stream_path[SSE_MAX_PATH];
+
+  // HTTP layer
+  HttpState http_state;
+  int status_code;
+  Header header;
+  bool chunked;
+  uint32_t chunk_remaining;
+  char location_text[SSE_MAX_LOCATION];
+  size_t location_length;
+
+  // SSE layer
+  LineState line_state;
+  Field field;
+  size_t field_length;
+  EventKind event_kind;
+  bool event_has_fields;
+
+  // JSON layer
+  JsonState json_state;
+  bool string_is_key;
+  uint8_t escape;           // 0, 1 after '\\', 2-5 inside \uXXXX
+  uint16_t unicode;
+  Role role;
+  Frame stack[SSE_MAX_DEPTH];
+  uint8_t depth;
+  char path[SSE_MAX_PATH];
+  uint8_t path_length;
+  uint8_t base_length;      // length of the event's path within path
+  bool base_too_long;
+  char token[SSE_MAX_TOKEN];
+  size_t token_length;
+  bool token_overflow;
+};
+
+#endif
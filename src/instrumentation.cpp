@@ -0,0 +1,82 @@
+/**
+ * Description:     Stage histograms and their RTDB summary
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include "instrumentation.h"
+
+#ifdef INSTRUMENTATION
+
+#include <stdio.h>
+#include "latency_histogram.h"
+#include "logger.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+#define DIAGNOSTICS_LATENCY_PATH "/diagnostics/latency"
+
+const uint32_t DIAGNOSTICS_PUBLISH_INTERVAL_MS = 60000;
+
+static const char* const STAGE_NAMES[STAGE_COUNT] = {
+  "stream_read",
+  "decode",
+  "queue_wait",
+  "apply",
+  "motion_step",
+};
+
+static const uint8_t SUMMARY_PERCENTILES[] = { 50, 90, 99 };
+
+
+static LatencyHistogram stage_histograms[STAGE_COUNT];
+
+// Filled on first use. Every task computes the same value, so the race is benign.
+static uint32_t cycles_per_us = 0;
+
+void instrumentation_record_cycles(uint8_t stage, uint32_t cycles) {
+  if (cycles_per_us == 0) cycles_per_us = hal_cycles_per_us();
+  instrumentation_record_ns(stage, (uint32_t)((uint64_t)cycles * 1000 / cycles_per_us));
+}
+
+void instrumentation_record_ns(uint8_t stage, uint32_t ns) {
+  if (stage >= STAGE_COUNT) return;
+  stage_histograms[stage].record(ns);
+}
+
+// {"uptime_ms":N,"unit":"ns","<stage>":[count,p50,p90,p99,max],...}
+// Counts are cumulative since boot.
+static int format_summary(char* buffer, size_t size, uint32_t now_ms) {
+  int length = snprintf(buffer, size, "{\"uptime_ms\":%u,\"unit\":\"ns\"", (unsigned)now_ms);
+
+  for (uint8_t i = 0; i < STAGE_COUNT && length > 0 && (size_t)length < size; i++) {
+    const LatencyHistogram& histogram = stage_histograms[i];
+    length += snprintf(buffer + length, size - length, ",\"%s\":[%u", STAGE_NAMES[i], (unsigned)histogram.count());
+    for (uint8_t p = 0; p < sizeof(SUMMARY_PERCENTILES) && (size_t)length < size; p++) {
+      length += snprintf(buffer + length, size - length, ",%u", (unsigned)histogram.percentile(SUMMARY_PERCENTILES[p]));
+    }
+    if ((size_t)length < size) length += snprintf(buffer + length, size - length, ",%u]", (unsigned)histogram.max());
+  }
+
+  if (length > 0 && (size_t)length < size) length += snprintf(buffer + length, size - length, "}");
+  return (size_t)length < size ? length : -1;
+}
+
+void instrumentation_publish(uint32_t now_ms) {
+  static uint32_t last_publish_ms = 0;
+  if (now_ms - last_publish_ms < DIAGNOSTICS_PUBLISH_INTERVAL_MS) return;
+  last_publish_ms = now_ms;
+
+  char summary[512];
+  if (format_summary(summary, sizeof(summary), now_ms) < 0) {
+    LOGGER_ERROR("Latency summary does not fit");
+    return;
+  }
+  if (!hal_rtdb_set_json(DIAGNOSTICS_LATENCY_PATH, summary)) {
+    LOGGER_WARN("Failed to publish latency summary: %s", hal_net_error());
+  }
+}
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * Description:     Hot-path latency instrumentation.
+ *
+ *                  Each stage between a stream event and an output edge gets
+ *                  a LatencyHistogram in static memory. Stages are timed with
+ *                  the CPU cycle counter (or the queue timestamp, for the hop
+ *                  between tasks) and a summary of every stage is published
+ *                  to /diagnostics/latency once a minute.
+ *
+ *                  Build with -DINSTRUMENTATION to enable it. Without it the
+ *                  macros below compile to nothing and no histogram memory is
+ *                  allocated.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <stdint.h>
+#include "hal/hal.h"
+
+// TO ADD A NEW STAGE: add it here and give it a name in STAGE_NAMES.
+// Each stage must only be recorded from one task.
+enum InstrumentedStage : uint8_t {
+  STAGE_STREAM_READ = 0,  // hal_stream_read() returning an event, decode included
+  STAGE_DECODE,           // path dispatch of one value into the coalescer
+  STAGE_QUEUE_WAIT,       // command decoded -> picked up by the actuator task
+  STAGE_APPLY,            // actuators_apply(): GPIO write or servo target
+  STAGE_MOTION_STEP,      // one planner step plus its servo writes
+  STAGE_COUNT
+};
+
+#ifdef INSTRUMENTATION
+
+#define INSTRUMENT_BEGIN(name) uint32_t name##_start_cycles = hal_cycles()
+#define INSTRUMENT_END(stage, name) instrumentation_record_cycles(stage, hal_cycles() - name##_start_cycles)
+#define INSTRUMENT_RECORD_NS(stage, ns) instrumentation_record_ns(stage, ns)
+
+void instrumentation_record_cycles(uint8_t stage, uint32_t cycles);
+void instrumentation_record_ns(uint8_t stage, uint32_t ns);
+
+// Publish the summary if the interval has elapsed. Network task only.
+void instrumentation_publish(uint32_t now_ms);
+
+#else
+
+#define INSTRUMENT_BEGIN(name) do {} while (0)
+#define INSTRUMENT_END(stage, name) do {} while (0)
+#define INSTRUMENT_RECORD_NS(stage, ns) do {} while (0)
+
+inline void instrumentation_publish(uint32_t now_ms) { (void)now_ms; }
+
+#endif
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * Description:     LAN packet verification and /lan publishing
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "lan_control.h"
+#include "lan_packet.h"
+#include "logger.h"
+#include "hal/hal.h"
+
+#define LAN_PUBLISH_PATH "/lan"
+
+// Wait between attempts to publish /lan after a failed write
+const uint32_t LAN_PUBLISH_RETRY_MS = 5000;
+
+static uint8_t session_key[SIPHASH_KEY_SIZE];
+static uint16_t listen_port = 0;
+
+static char published_ip[16] = "";
+static uint32_t last_publish_attempt_ms = 0;
+static bool publish_attempted = false;
+
+static uint32_t rejected_packets = 0;
+
+void lan_control_begin(void) {
+  for (uint8_t i = 0; i < SIPHASH_KEY_SIZE; i += 4) {
+    uint32_t random = hal_random();
+    memcpy(session_key + i, &random, sizeof(random));
+  }
+
+  listen_port = hal_lan_begin(LAN_CONTROL_PORT);
+  if (listen_port == 0) LOGGER_ERROR("Failed to start LAN control endpoint");
+  else LOGGER_INFO("LAN control on %s port %u", HAL_LAN_TRANSPORT, listen_port);
+}
+
+static void reject(const char* reason) {
+  (void)reason;   // only used when debug logging is compiled in
+  rejected_packets++;
+  LOGGER_DEBUG("Rejected LAN packet (%s), %u total", reason, (unsigned)rejected_packets);
+}
+
+void lan_control_poll(CommandSink sink) {
+  if (listen_port == 0) return;
+
+  uint8_t message[HAL_LAN_MAX_MESSAGE];
+  size_t length;
+  while ((length = hal_lan_read(message, sizeof(message))) > 0) {
+    uint32_t now_us = hal_micros();
+    ServoFrame frame;
+    if (!lan_packet_decode(message, length, session_key, frame)) reject("bad tag");
+    else if (!dispatch_servo_frame(frame, now_us, sink)) reject("replayed or not a gimbal");
+  }
+}
+
+void lan_control_publish(uint32_t now_ms) {
+  if (listen_port == 0) return;
+
+  char ip[sizeof(published_ip)];
+  if (!hal_wifi_local_ip(ip, sizeof(ip)) || strcmp(ip, published_ip) == 0) return;
+  if (publish_attempted && now_ms - last_publish_attempt_ms < LAN_PUBLISH_RETRY_MS) return;
+  publish_attempted = true;
+  last_publish_attempt_ms = now_ms;
+
+  char key_hex[2 * SIPHASH_KEY_SIZE + 1];
+  for (uint8_t i = 0; i < SIPHASH_KEY_SIZE; i++) snprintf(key_hex + 2 * i, 3, "%02x", session_key[i]);
+
+  char json[128];
+  snprintf(json, sizeof(json), "{\"ip\":\"%s\",\"port\":%u,\"transport\":\"%s\",\"key\":\"%s\"}", ip,
+           (unsigned)listen_port, HAL_LAN_TRANSPORT, key_hex);
+  if (!hal_rtdb_set_json(LAN_PUBLISH_PATH, json)) {
+    LOGGER_WARN("Failed to publish LAN address: %s", hal_net_error());
+    return;
+  }
+  memcpy(published_ip, ip, sizeof(published_ip));
+}
@@ -0,0 +1,47 @@
+/**
+ * Description:     Direct LAN control channel.
+ *
+ *                  Joystick moves take browser -> Firebase -> device stream,
+ *                  a few hundred ms even when the browser sits on the same
+ *                  WiFi. This channel takes the shortcut: clients on the LAN
+ *                  send authenticated servo frames (lan_packet.h) straight
+ *                  to the device's endpoint, and they are decoded into the
+ *                  same commands as stream values.
+ *
+ *                  A fresh random session key is drawn at every boot and
+ *                  published with the device's address to /lan:
+ *
+ *                    {"ip": "192.168.1.20", "port": 8181, "transport": "ws",
+ *                     "key": "<32 hex digits>"}
+ *
+ *                  Clients that can read the database use it; everything
+ *                  else falls back to writing the RTDB, which stays the
+ *                  source of truth (the web app writes the final position
+ *                  there as well).
+ *
+ *                  Network task only.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef LAN_CONTROL_H
+#define LAN_CONTROL_H
+
+#include "stream_dispatch.h"
+
+// Port the endpoint asks for
+const uint16_t LAN_CONTROL_PORT = 8181;
+
+// Draw the session key and start the endpoint
+void lan_control_begin(void);
+
+// Decode every pending packet into commands for sink. Never blocks.
+void lan_control_poll(CommandSink sink);
+
+// Publish the address and key to /lan if they are not there yet or the
+// address changed. Blocks for one request when it writes; call while the
+// RTDB is up.
+void lan_control_publish(uint32_t now_ms);
+
+#endif
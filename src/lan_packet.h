@@ -0,0 +1,56 @@
+/**
+ * Description:     Authenticated packets for the LAN control channel.
+ *
+ *                  A packet is one servo frame (servo_frame.h) followed by
+ *                  its tag:
+ *
+ *                    offset  size  field
+ *                    0       10    servo frame
+ *                    10      8     SipHash-2-4 tag of bytes 0-9
+ *
+ *                  The tag is keyed with the session key the device publishes
+ *                  to the RTDB, so only clients that can read the database
+ *                  can drive it. The frame's sequence number is what rejects
+ *                  replays.
+ *
+ *                  Header-only so the host tools encode exactly what the
+ *                  firmware decodes.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef LAN_PACKET_H
+#define LAN_PACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "servo_frame.h"
+#include "siphash.h"
+
+const uint8_t LAN_PACKET_TAG_OFFSET = SERVO_FRAME_SIZE;
+const uint8_t LAN_PACKET_SIZE = LAN_PACKET_TAG_OFFSET + 8;
+
+// Writes LAN_PACKET_SIZE bytes
+inline void lan_packet_encode(const ServoFrame& frame, const uint8_t key[SIPHASH_KEY_SIZE],
+                              uint8_t bytes[LAN_PACKET_SIZE]) {
+  servo_frame_encode(frame, bytes);
+  uint64_t tag = siphash24(key, bytes, LAN_PACKET_TAG_OFFSET);
+  servo_frame_put_u32(bytes + LAN_PACKET_TAG_OFFSET, (uint32_t)tag);
+  servo_frame_put_u32(bytes + LAN_PACKET_TAG_OFFSET + 4, (uint32_t)(tag >> 32));
+}
+
+// Returns false if the packet is malformed or its tag does not match. The
+// sequence number is left for the caller to check.
+inline bool lan_packet_decode(const uint8_t* bytes, size_t length, const uint8_t key[SIPHASH_KEY_SIZE],
+                              ServoFrame& frame) {
+  if (length != LAN_PACKET_SIZE) return false;
+
+  uint64_t tag = siphash24(key, bytes, LAN_PACKET_TAG_OFFSET);
+  uint64_t received = servo_frame_get_u32(bytes + LAN_PACKET_TAG_OFFSET) |
+                      ((uint64_t)servo_frame_get_u32(bytes + LAN_PACKET_TAG_OFFSET + 4) << 32);
+  if (tag != received) return false;
+  return servo_frame_decode(bytes, LAN_PACKET_TAG_OFFSET, frame);
+}
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * Description:     Fixed-size log-linear latency histogram.
+ *
+ *                  Values (nanoseconds) land in buckets that double in width
+ *                  every power of two, with SUB_BUCKETS linear steps inside
+ *                  each power, so the relative error stays under 1/SUB_BUCKETS
+ *                  from a few ns up to seconds in a few hundred bytes of
+ *                  static memory. Recording is an index computation and an
+ *                  increment: no allocation, no locks, no floating point.
+ *
+ *                  Each histogram must have a single writer. A reader on
+ *                  another task may see a sample counted in one field and not
+ *                  yet in another, which is fine for a summary.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+
+class LatencyHistogram {
+public:
+  static const uint8_t SUB_BUCKET_BITS = 2;
+  static const uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+
+  // Values below SUB_BUCKETS get a bucket each; every power of two above
+  // that gets SUB_BUCKETS more
+  static const uint32_t BUCKET_COUNT = SUB_BUCKETS + (32 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+  LatencyHistogram() { reset(); }
+
+  void record(uint32_t value) {
+    buckets[bucket_index(value)]++;
+    total++;
+    if (value > maximum) maximum = value;
+  }
+
+  void reset(void) {
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) buckets[i] = 0;
+    total = 0;
+    maximum = 0;
+  }
+
+  uint32_t count(void) const { return total; }
+  uint32_t max(void) const { return maximum; }
+
+  // Upper bound of the bucket holding the given percentile (0-100), capped
+  // at the largest value seen. 0 when empty.
+  uint32_t percentile(uint8_t percent) const {
+    uint32_t samples = total;
+    if (samples == 0) return 0;
+
+    uint64_t rank = ((uint64_t)samples * percent + 99) / 100;
+    if (rank == 0) rank = 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+      seen += buckets[i];
+      if (seen >= rank) {
+        uint32_t upper = bucket_upper_bound(i);
+        return upper < maximum ? upper : maximum;
+      }
+    }
+    return maximum;
+  }
+
+  static uint32_t bucket_index(uint32_t value) {
+    if (value < SUB_BUCKETS) return value;
+    uint32_t msb = 31 - __builtin_clz(value);
+    uint32_t sub = (value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+  }
+
+  // Largest value that maps to bucket index
+  static uint32_t bucket_upper_bound(uint32_t index) {
+    if (index < SUB_BUCKETS) return index;
+    uint32_t msb = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint32_t sub = index % SUB_BUCKETS;
+    uint32_t width = 1u << (msb - SUB_BUCKET_BITS);
+    uint64_t lower = ((uint64_t)1 << msb) + (uint64_t)sub * width;
+    return (uint32_t)(lower + width - 1);
+  }
+
+private:
+  volatile uint32_t buckets[BUCKET_COUNT];
+  volatile uint32_t total;
+  volatile uint32_t maximum;
+};
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * Description:     Ring-buffered logger and its drain task
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+#include "logger.h"
+#include "mpsc_ring.h"
+#include "stream_recorder.h"
+#include "hal/hal.h"
+
+// How often the logger task wakes up to drain the ring
+const uint32_t LOGGER_DRAIN_INTERVAL_MS = 50;
+
+struct LogRecord {
+  uint32_t timestamp_ms;
+  uint8_t level;
+  char text[LOGGER_LINE_LENGTH];
+};
+
+static MpscRing<LogRecord, LOGGER_RING_CAPACITY> log_ring;
+static std::atomic<uint32_t> dropped_lines(0);
+
+static const char LEVEL_TAGS[] = { '-', 'E', 'W', 'I', 'D' };
+
+void logger_write(uint8_t level, const char* format, ...) {
+  LogRecord record;
+  record.timestamp_ms = hal_millis();
+  record.level = level;
+
+  va_list args;
+  va_start(args, format);
+  vsnprintf(record.text, sizeof(record.text), format, args);
+  va_end(args);
+
+  if (!log_ring.push(record)) dropped_lines.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t logger_drain(void) {
+  static uint32_t reported_drops = 0;
+  char line[LOGGER_LINE_LENGTH + 24];
+  LogRecord record;
+  uint32_t written = 0;
+
+  while (log_ring.pop(record)) {
+    char tag = record.level < sizeof(LEVEL_TAGS) ? LEVEL_TAGS[record.level] : '?';
+    int length = snprintf(line, sizeof(line), "%10u %c %s\n", (unsigned)record.timestamp_ms, tag, record.text);
+    if (length > (int)sizeof(line) - 1) length = sizeof(line) - 1;
+    hal_console_write(line, length);
+    written++;
+  }
+
+  uint32_t dropped = dropped_lines.load(std::memory_order_relaxed);
+  if (dropped != reported_drops) {
+    int length = snprintf(line, sizeof(line), "%10u W Logger dropped %u lines\n", (unsigned)hal_millis(),
+                          (unsigned)(dropped - reported_drops));
+    hal_console_write(line, length);
+    reported_drops = dropped;
+  }
+  return written;
+}
+
+uint32_t logger_dropped(void) {
+  return dropped_lines.load(std::memory_order_relaxed);
+}
+
+void logger_task(void* pvParameters) {
+  (void)pvParameters;
+  for (;;) {
+    logger_drain();
+    stream_recorder_drain();
+    hal_task_delay_ms(LOGGER_DRAIN_INTERVAL_MS);
+  }
+}
@@ -0,0 +1,78 @@
+/**
+ * Description:     Asynchronous logger.
+ *
+ *                  LOGGER_ERROR/WARN/INFO/DEBUG format the line into a
+ *                  lock-free ring in RAM and return; they never touch the
+ *                  UART. The low-priority logger task drains the ring to the
+ *                  console, so a burst of errors while the stream flaps costs
+ *                  the network and actuator tasks a vsnprintf each instead of
+ *                  milliseconds of blocking serial output. If the ring is full
+ *                  the line is dropped and counted.
+ *
+ *                  Levels above LOGGER_LEVEL compile to nothing, arguments
+ *                  included. Set it with a build flag, ex:
+ *                  -DLOGGER_LEVEL=LOGGER_LEVEL_DEBUG
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+
+#define LOGGER_LEVEL_NONE   0
+#define LOGGER_LEVEL_ERROR  1
+#define LOGGER_LEVEL_WARN   2
+#define LOGGER_LEVEL_INFO   3
+#define LOGGER_LEVEL_DEBUG  4
+
+#ifndef LOGGER_LEVEL
+#define LOGGER_LEVEL LOGGER_LEVEL_INFO
+#endif
+
+#if LOGGER_LEVEL >= LOGGER_LEVEL_ERROR
+#define LOGGER_ERROR(...) logger_write(LOGGER_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOGGER_ERROR(...) do {} while (0)
+#endif
+
+#if LOGGER_LEVEL >= LOGGER_LEVEL_WARN
+#define LOGGER_WARN(...) logger_write(LOGGER_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOGGER_WARN(...) do {} while (0)
+#endif
+
+#if LOGGER_LEVEL >= LOGGER_LEVEL_INFO
+#define LOGGER_INFO(...) logger_write(LOGGER_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOGGER_INFO(...) do {} while (0)
+#endif
+
+#if LOGGER_LEVEL >= LOGGER_LEVEL_DEBUG
+#define LOGGER_DEBUG(...) logger_write(LOGGER_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOGGER_DEBUG(...) do {} while (0)
+#endif
+
+// Longest line kept, including the terminator. Longer lines are truncated.
+const uint32_t LOGGER_LINE_LENGTH = 96;
+
+// Lines that can wait for the logger task
+const uint32_t LOGGER_RING_CAPACITY = 32;
+
+// Queue one line (no trailing newline needed). Safe from any task; never blocks.
+void logger_write(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+// Write every queued line to the console. Returns how many were written.
+// Only the logger task (or a single-threaded tool) may call this.
+uint32_t logger_drain(void);
+
+// Lines dropped because the ring was full, since boot
+uint32_t logger_dropped(void);
+
+// FreeRTOS task body draining the ring. pvParameters is unused.
+void logger_task(void* pvParameters);
+
+#endif
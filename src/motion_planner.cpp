@@ -0,0 +1,104 @@
+/**
+ * Description:     Trapezoidal trajectory generation for the servo axes
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include "motion_planner.h"
+#include <math.h>
+
+// Distance and speed below which an axis is considered settled
+static const float SETTLE_DISTANCE = 0.01f;
+static const float SETTLE_VELOCITY = 0.5f;
+
+// Slowest a synchronized axis is scaled to, so an axis with next to no
+// distance to cover can still correct itself
+static const float MIN_SYNC_SCALE = 0.1f;
+
+static float clampf(float value, float low, float high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+MotionPlanner::MotionPlanner() {
+  AxisLimits defaults = { 0.0f, 180.0f, 180.0f, 720.0f };
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) configure(i, defaults, 90.0f);
+}
+
+void MotionPlanner::configure(uint8_t axis, const AxisLimits& limits, float initial_angle) {
+  if (axis >= AXIS_COUNT) return;
+  Axis& a = axes[axis];
+  a.limits = limits;
+  a.position = clampf(initial_angle, limits.min_angle, limits.max_angle);
+  a.velocity = 0.0f;
+  a.target = a.position;
+  a.scale = 1.0f;
+}
+
+void MotionPlanner::set_target(uint8_t axis, float target) {
+  if (axis >= AXIS_COUNT) return;
+  axes[axis].target = clampf(target, axes[axis].limits.min_angle, axes[axis].limits.max_angle);
+  axes[axis].scale = 1.0f;
+}
+
+void MotionPlanner::set_targets(uint8_t axis_a, float target_a, uint8_t axis_b, float target_b) {
+  if (axis_a >= AXIS_COUNT || axis_b >= AXIS_COUNT || axis_a == axis_b) return;
+  set_target(axis_a, target_a);
+  set_target(axis_b, target_b);
+
+  // Time each move would take at full speed, roughly. Exact when both axes
+  // have the same limits, as a gimbal's do.
+  Axis& a = axes[axis_a];
+  Axis& b = axes[axis_b];
+  float time_a = fabsf(a.target - a.position) / a.limits.max_velocity;
+  float time_b = fabsf(b.target - b.position) / b.limits.max_velocity;
+  float longest = time_a > time_b ? time_a : time_b;
+  if (longest <= 0.0f) return;
+  a.scale = clampf(time_a / longest, MIN_SYNC_SCALE, 1.0f);
+  b.scale = clampf(time_b / longest, MIN_SYNC_SCALE, 1.0f);
+}
+
+void MotionPlanner::step(float dt) {
+  if (dt <= 0.0f) return;
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) step_axis(axes[i], dt);
+}
+
+bool MotionPlanner::moving(uint8_t axis) const {
+  if (axis >= AXIS_COUNT) return false;
+  const Axis& a = axes[axis];
+  return a.position != a.target || a.velocity != 0.0f;
+}
+
+void MotionPlanner::step_axis(Axis& axis, float dt) {
+  float distance = axis.target - axis.position;
+  float v_max = axis.limits.max_velocity * axis.scale;
+  float a_max = axis.limits.max_acceleration * axis.scale;
+
+  if (fabsf(distance) <= SETTLE_DISTANCE && fabsf(axis.velocity) <= SETTLE_VELOCITY) {
+    axis.position = axis.target;
+    axis.velocity = 0.0f;
+    return;
+  }
+
+  // Fastest speed from which the axis can still stop at the target, capped
+  // at the axis limit. Heading away from the target means braking first.
+  float direction = distance > 0.0f ? 1.0f : -1.0f;
+  float stop_speed = sqrtf(2.0f * a_max * fabsf(distance));
+  float desired_velocity = direction * (stop_speed < v_max ? stop_speed : v_max);
+
+  // Move toward the desired velocity without exceeding the acceleration
+  // limit. Slowing down may use the axis' full deceleration.
+  bool braking = fabsf(desired_velocity) < fabsf(axis.velocity) || desired_velocity * axis.velocity < 0.0f;
+  float dv_max = (braking ? axis.limits.max_acceleration : a_max) * dt;
+  float dv = clampf(desired_velocity - axis.velocity, -dv_max, dv_max);
+  axis.velocity += dv;
+
+  float travel = axis.velocity * dt;
+  // Land exactly on the target instead of stepping past it
+  if ((distance > 0.0f && travel >= distance) || (distance < 0.0f && travel <= distance)) {
+    axis.position = axis.target;
+    axis.velocity = 0.0f;
+    return;
+  }
+  axis.position += travel;
+}
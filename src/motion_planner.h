@@ -0,0 +1,87 @@
+/**
+ * Description:     Velocity/acceleration-limited motion planner for the
+ *                  camera and laser servos.
+ *
+ *                  Each axis tracks a target angle with a trapezoidal velocity
+ *                  profile: it accelerates up to its maximum velocity and
+ *                  starts braking as soon as the remaining distance equals
+ *                  its stopping distance, so it lands on the target without
+ *                  overshoot. A new target can be set at any time and the
+ *                  trajectory re-plans from the current position and velocity.
+ *
+ *                  Two axes given targets together (a gimbal pose) are
+ *                  synchronized: the axis with the shorter move has its
+ *                  velocity and acceleration limits scaled down by the ratio
+ *                  of the moves, so both profiles have the same shape and
+ *                  finish together. From rest the beam or camera then travels
+ *                  in a straight line instead of an L. Braking always gets
+ *                  the full deceleration, so a scaled axis retargeted at
+ *                  speed still stops in time.
+ *
+ *                  The planner owns no clock. step() advances every axis by an
+ *                  explicit dt, so the same sequence of targets and steps
+ *                  always produces the same trajectory, on the device or on
+ *                  the host with a simulated clock.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef MOTION_PLANNER_H
+#define MOTION_PLANNER_H
+
+#include <stdint.h>
+
+enum ServoAxis : uint8_t {
+  AXIS_CAMERA_X = 0,
+  AXIS_CAMERA_Y,
+  AXIS_LASER_X,
+  AXIS_LASER_Y,
+  AXIS_COUNT
+};
+
+struct AxisLimits {
+  float min_angle;          // degrees
+  float max_angle;          // degrees
+  float max_velocity;       // degrees/s
+  float max_acceleration;   // degrees/s^2
+};
+
+class MotionPlanner {
+public:
+  MotionPlanner();
+
+  // Set an axis' limits and place it at rest at initial_angle
+  void configure(uint8_t axis, const AxisLimits& limits, float initial_angle);
+
+  // Set a new target angle, clamped to the axis limits
+  void set_target(uint8_t axis, float target);
+
+  // Set targets for two axes that should arrive together
+  void set_targets(uint8_t axis_a, float target_a, uint8_t axis_b, float target_b);
+
+  // Advance every axis by dt seconds
+  void step(float dt);
+
+  float position(uint8_t axis) const { return axes[axis].position; }
+  float velocity(uint8_t axis) const { return axes[axis].velocity; }
+  float target(uint8_t axis) const { return axes[axis].target; }
+
+  // True while the axis has not settled on its target
+  bool moving(uint8_t axis) const;
+
+private:
+  struct Axis {
+    AxisLimits limits;
+    float position;
+    float velocity;
+    float target;
+    float scale;            // fraction of the limits used toward the target
+  };
+
+  static void step_axis(Axis& axis, float dt);
+
+  Axis axes[AXIS_COUNT];
+};
+
+#endif
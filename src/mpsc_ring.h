@@ -0,0 +1,87 @@
+/**
+ * Description:     Fixed-capacity, allocation-free multi-producer/single-
+ *                  consumer ring buffer.
+ *
+ *                  Any number of tasks may call push() concurrently; exactly
+ *                  one task may call pop(). Each slot carries a sequence
+ *                  number saying whose turn it is. A producer claims the next
+ *                  slot with a compare-and-swap on the head, fills it, then
+ *                  publishes it by advancing the slot's sequence, so the
+ *                  consumer never sees a half-written item and nobody ever
+ *                  takes a lock. A producer that finds the ring full gets
+ *                  false back immediately.
+ *
+ *                  Plain C++ with no Arduino dependencies so it can be built
+ *                  and exercised on the host.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include <atomic>
+#include <stdint.h>
+#include "cache_line.h"
+
+template <typename T, uint32_t CAPACITY>
+class MpscRing {
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+  MpscRing() : head(0), tail(0) {
+    for (uint32_t i = 0; i < CAPACITY; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  // Any producer. Returns false without modifying the ring when it is full.
+  bool push(const T& item) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = slots[h & (CAPACITY - 1)];
+      int32_t lag = (int32_t)(slot.sequence.load(std::memory_order_acquire) - h);
+      if (lag < 0) return false;
+
+      // Slot is free for position h; try to claim it. On failure h is
+      // reloaded with the current head and we try again.
+      if (lag == 0) {
+        if (head.compare_exchange_weak(h, h + 1, std::memory_order_relaxed)) {
+          slot.item = item;
+          slot.sequence.store(h + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else {
+        h = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumer only. Returns false when the ring is empty or the oldest slot
+  // is claimed but not yet published.
+  bool pop(T& item) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    Slot& slot = slots[t & (CAPACITY - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != t + 1) return false;
+    item = slot.item;
+    slot.sequence.store(t + CAPACITY, std::memory_order_release);
+    tail.store(t + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  static uint32_t capacity(void) { return CAPACITY; }
+
+private:
+  struct Slot {
+    std::atomic<uint32_t> sequence;
+    T item;
+  };
+
+  // Producers contend on head and the consumer owns tail, so each starts a
+  // cache line of its own
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> head;
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> tail;
+  Slot slots[CAPACITY];
+};
+
+#endif
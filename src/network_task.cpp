@@ -0,0 +1,217 @@
+/**
+ * Description:     Device stream reading and decoding
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "network_task.h"
+#include "actuators.h"
+#include "actuator_task.h"
+#include "command_coalescer.h"
+#include "connection_manager.h"
+#include "device_shadow.h"
+#include "device_table.h"
+#include "instrumentation.h"
+#include "lan_control.h"
+#include "stream_dispatch.h"
+#include "stream_recorder.h"
+#include "telemetry.h"
+#include "logger.h"
+#include "hal/hal.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+// RTDB URL (DO NOT CHANGE)
+#define REALTIME_DATABASE_URL "cat-automated-smart-home-default-rtdb.firebaseio.com"
+
+// Each tower keeps to its own subtree, DEVICE_NAMESPACE/<chip id>, so many
+// can share one database. Every path below is relative to it.
+#define DEVICE_NAMESPACE "/devices"
+
+// Desired state, and the only node the device streams. The uplinks
+// (/reported, /telemetry, /diagnostics, /lan) are its siblings, so writing
+// them never comes back down the stream. Device table paths are relative to
+// it.
+#define DEVICE_STREAM_PATH "/state"
+
+// Network credentials (will not be pushed)
+
+
+// const char* WIFI_SSID = "SSID";
+// const char* WIFI_PASSWORD = "password";
+
+#ifndef ARDUINO
+// The host backend never joins a real network
+const char* WIFI_SSID = "host";
+const char* WIFI_PASSWORD = "";
+#endif
+
+// Stream events read back-to-back before pending commands are flushed, so a
+// backlog is collapsed without starving the actuator during a long burst
+const uint8_t MAX_COALESCED_EVENTS = 32;
+
+// How often the number of coalesced (dropped) commands is reported
+const uint32_t COALESCE_REPORT_INTERVAL_MS = 5000;
+
+// Sleep between connection manager ticks while the stream is down. Short
+// enough that a backoff expiring is noticed promptly.
+const uint32_t LINK_POLL_INTERVAL_MS = 20;
+
+static CommandCoalescer command_coalescer;
+
+// DEVICE_NAMESPACE "/" + chip id
+static char device_root[48];
+
+// Every device path, the shadow version, the servo frame paths and the
+// pose leaves
+const uint8_t WATCHED_PATH_COUNT = DEVICE_CHANNEL_COUNT + 1 + SERVO_FRAME_PATH_COUNT + POSE_LEAF_COUNT;
+static const char* watched_paths[WATCHED_PATH_COUNT];
+
+// Hands a decoded command to the actuator task without ever blocking the
+// network side. A full ring means the actuator is far behind, so the
+// command is dropped rather than stalling the stream.
+static void send_command(const Command& command) {
+  if (!actuator_task_submit(command)) {
+    LOGGER_WARN("Command ring full. Dropped command for device %u", command.device);
+  }
+}
+
+// Values the device already wants (ex: most of a reconnect snapshot) are
+// dropped here instead of being actuated again
+static void stage_command(const Command& command) {
+  if (shadow_accept(command)) command_coalescer.add(command);
+}
+
+static void on_stream_value(const char* path, int value) {
+  stream_recorder_value(path, value);
+  if (strcmp(path, SHADOW_VERSION_PATH) == 0) {
+    shadow_set_version((uint32_t)value);
+    return;
+  }
+  if (dispatch_pose_leaf(path, value)) return;
+
+  INSTRUMENT_BEGIN(decode);
+  dispatch_stream_value(path, value, hal_micros(), stage_command);
+  INSTRUMENT_END(STAGE_DECODE, decode);
+}
+
+static void on_stream_text(const char* path, const char* text) {
+  stream_recorder_text(path, text);
+  INSTRUMENT_BEGIN(decode);
+  if (!dispatch_servo_frame_text(path, text, hal_micros(), stage_command)) {
+    LOGGER_DEBUG("Ignored text at %s", path);
+  }
+  INSTRUMENT_END(STAGE_DECODE, decode);
+}
+
+static bool begin_device_stream(void) {
+  return hal_stream_begin(DEVICE_STREAM_PATH, watched_paths, WATCHED_PATH_COUNT);
+}
+
+// Periodically reports how many superseded commands were never actuated
+static void report_coalesced_commands(void) {
+  static uint32_t last_report_ms = 0;
+  static uint32_t last_reported_count = 0;
+
+  uint32_t now = hal_millis();
+  if (now - last_report_ms < COALESCE_REPORT_INTERVAL_MS) return;
+  last_report_ms = now;
+
+  uint32_t dropped = command_coalescer.dropped();
+  if (dropped == last_reported_count) return;
+  LOGGER_INFO("Coalesced %u superseded commands (%u total)", (unsigned)(dropped - last_reported_count),
+              (unsigned)dropped);
+  last_reported_count = dropped;
+}
+
+void network_begin(void) {
+  for (uint8_t row = 0; row < DEVICE_CHANNEL_COUNT; row++) watched_paths[row] = DeviceIndex::paths[row];
+  watched_paths[DEVICE_CHANNEL_COUNT] = SHADOW_VERSION_PATH;
+  for (uint8_t i = 0; i < SERVO_FRAME_PATH_COUNT; i++) {
+    watched_paths[DEVICE_CHANNEL_COUNT + 1 + i] = SERVO_FRAME_PATHS[i].path;
+  }
+  const char** pose_leaves = watched_paths + DEVICE_CHANNEL_COUNT + 1 + SERVO_FRAME_PATH_COUNT;
+  for (uint8_t i = 0; i < POSE_PATH_COUNT; i++) {
+    pose_leaves[3 * i] = POSE_PATHS[i].x;
+    pose_leaves[3 * i + 1] = POSE_PATHS[i].y;
+    pose_leaves[3 * i + 2] = POSE_PATHS[i].seq;
+  }
+  shadow_begin();
+  lan_control_begin();
+
+  // Both calls return immediately. The connection manager takes it from here,
+  // so the actuators are live even while the network is still coming up.
+  char chip_id[24];
+  hal_chip_id(chip_id, sizeof(chip_id));
+  snprintf(device_root, sizeof(device_root), "%s/%s", DEVICE_NAMESPACE, chip_id);
+  LOGGER_INFO("Device root: %s", device_root);
+
+  LOGGER_INFO("Connecting to: %s", WIFI_SSID);
+  hal_wifi_begin(WIFI_SSID, WIFI_PASSWORD);
+  hal_rtdb_begin(REALTIME_DATABASE_URL, device_root);
+
+  // Once the RTDB is up, the device stream is opened. Its first event is a
+  // snapshot of the whole desired state, which the shadow diffs against what the
+  // actuators already hold, so only fields that changed are actuated.
+  connection_manager_begin(begin_device_stream);
+}
+
+void network_task(void* pvParameters) {
+  (void)pvParameters;
+  uint8_t coalesced_events = 0;
+
+  for (;;) {
+    // Advance the WiFi/RTDB/stream state machines. Never blocks; a dropped
+    // link is retried with backoff on a later pass.
+    connection_manager_tick(hal_millis());
+    if (!connection_manager_stream_up()) {
+      // The LAN channel keeps working without the cloud
+      lan_control_poll(stage_command);
+      command_coalescer.flush(send_command);
+      actuators_persist(hal_millis());
+      telemetry_tick(hal_millis(), connection_manager_state(LINK_RTDB) == LINK_UP);
+      hal_task_delay_ms(LINK_POLL_INTERVAL_MS);
+      continue;
+    }
+
+    // Read the device stream and decode its event into staged commands.
+    // While events keep arriving back-to-back, keep reading so a burst
+    // collapses to the newest value per channel before it is actuated.
+    INSTRUMENT_BEGIN(stream_read);
+    HalStreamResult result = hal_stream_read(on_stream_value, on_stream_text);
+    if (result == HAL_STREAM_EVENT) {
+      INSTRUMENT_END(STAGE_STREAM_READ, stream_read);
+      stream_recorder_event_end();
+    }
+    dispatch_pose_event_end(hal_micros(), stage_command);
+    if (result == HAL_STREAM_TIMEOUT) connection_manager_stream_failed(hal_millis());
+    else if (result == HAL_STREAM_ERROR) {
+      LOGGER_ERROR("Stream read failed: %s", hal_net_error());
+      connection_manager_stream_failed(hal_millis());
+    }
+
+    lan_control_poll(stage_command);
+
+    bool event_available = result == HAL_STREAM_EVENT;
+    if (event_available) {
+      if (++coalesced_events < MAX_COALESCED_EVENTS) continue;
+    }
+
+    command_coalescer.flush(send_command);
+    coalesced_events = 0;
+    report_coalesced_commands();
+    shadow_reconcile(hal_millis(), send_command);
+    actuators_persist(hal_millis());
+    instrumentation_publish(hal_millis());
+    telemetry_tick(hal_millis(), true);
+    lan_control_publish(hal_millis());
+
+    // Nothing pending on the socket. Yield for a tick instead of spinning so
+    // the WiFi/lwIP tasks on this core can deliver the next packet.
+    if (!event_available) hal_task_yield_tick();
+  }
+}
@@ -0,0 +1,22 @@
+/**
+ * Description:     Network side of the firmware. Owns the WiFi and RTDB
+ *                  connections, reads the device stream and pushes decoded
+ *                  commands to the actuator task.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef NETWORK_TASK_H
+#define NETWORK_TASK_H
+
+
+// Start connecting to WiFi and the RTDB. Returns immediately; the network
+// task brings the links (and the device stream) up as they become available.
+// Call after actuators_init(); the device shadow starts from their state.
+void network_begin(void);
+
+// FreeRTOS task body. pvParameters is unused.
+void network_task(void* pvParameters);
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * Description:     Packed binary frames for high-rate gimbal control.
+ *
+ *                  A joystick move as JSON is two ints in a multi-path update
+ *                  that the RTDB client parses and copies into Strings. A
+ *                  frame carries the same move for both axes in 10 bytes:
+ *
+ *                    offset  size  field
+ *                    0       1     type (SERVO_FRAME_PULSES)
+ *                    1       1     device (DeviceId)
+ *                    2       4     sequence number
+ *                    6       2     x pulse width, microseconds
+ *                    8       2     y pulse width, microseconds
+ *
+ *                  Little-endian throughout. Targets are servo pulse widths,
+ *                  the unit the servos are driven in; the firmware converts
+ *                  them to tenths of a degree for the motion planner.
+ *                  Sequence numbers must keep increasing (serial number
+ *                  arithmetic) per device, across transports, so a late
+ *                  frame never undoes a newer one.
+ *
+ *                  The same bytes travel two ways: as the body of a LAN
+ *                  packet (lan_packet.h), and base64-encoded as a string at
+ *                  the gimbal's SERVO_FRAME_PATHS entry in the RTDB.
+ *
+ *                  Header-only so the host tools encode exactly what the
+ *                  firmware decodes. Nothing here allocates.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef SERVO_FRAME_H
+#define SERVO_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "base64.h"
+#include "command.h"
+
+const uint8_t SERVO_FRAME_PULSES = 2;
+const uint8_t SERVO_FRAME_SIZE = 10;
+
+// Room for a frame as base64 text, with its terminator
+const size_t SERVO_FRAME_TEXT_SIZE = base64_encoded_size(SERVO_FRAME_SIZE) + 1;
+
+// Pulse widths for 0 and 180 degrees (the ESP32Servo defaults the servos
+// were calibrated against)
+const uint16_t SERVO_MIN_PULSE_US = 544;
+const uint16_t SERVO_MAX_PULSE_US = 2400;
+
+struct ServoFrame {
+  uint8_t device;
+  uint32_t seq;
+  uint16_t x_us;
+  uint16_t y_us;
+};
+
+// RTDB path each gimbal's base64 frames are written to
+struct ServoFramePath {
+  const char* path;
+  uint8_t device;
+};
+
+const ServoFramePath SERVO_FRAME_PATHS[] = {
+  { "/camera_servo/frame", DEVICE_CAMERA },
+  { "/laser_servo/frame",  DEVICE_LASER },
+};
+
+const uint8_t SERVO_FRAME_PATH_COUNT = sizeof(SERVO_FRAME_PATHS) / sizeof(SERVO_FRAME_PATHS[0]);
+
+
+// ============================================================================
+//                                 CONVERSION
+// ============================================================================
+inline uint16_t servo_angle_to_pulse_us(int angle) {
+  if (angle < 0) angle = 0;
+  if (angle > 180) angle = 180;
+  return (uint16_t)(SERVO_MIN_PULSE_US + (angle * (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) + 90) / 180);
+}
+
+// Nearest whole degree; pulses outside the servo's range clamp to 0 or 180
+inline int servo_pulse_us_to_angle(uint16_t pulse_us) {
+  if (pulse_us <= SERVO_MIN_PULSE_US) return 0;
+  if (pulse_us >= SERVO_MAX_PULSE_US) return 180;
+  const int span = SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US;
+  return ((pulse_us - SERVO_MIN_PULSE_US) * 180 + span / 2) / span;
+}
+
+// Nearest tenth of a degree (a pose's unit), clamped the same way. A tenth is
+// about one microsecond of pulse width, so frames keep their resolution.
+inline int16_t servo_pulse_us_to_tenths(uint16_t pulse_us) {
+  if (pulse_us <= SERVO_MIN_PULSE_US) return 0;
+  if (pulse_us >= SERVO_MAX_PULSE_US) return 180 * POSE_UNITS_PER_DEGREE;
+  const int span = SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US;
+  return (int16_t)(((pulse_us - SERVO_MIN_PULSE_US) * 180 * POSE_UNITS_PER_DEGREE + span / 2) / span);
+}
+
+
+// ============================================================================
+//                                   CODEC
+// ============================================================================
+inline void servo_frame_put_u16(uint8_t* bytes, uint16_t value) {
+  bytes[0] = (uint8_t)value;
+  bytes[1] = (uint8_t)(value >> 8);
+}
+
+inline void servo_frame_put_u32(uint8_t* bytes, uint32_t value) {
+  servo_frame_put_u16(bytes, (uint16_t)value);
+  servo_frame_put_u16(bytes + 2, (uint16_t)(value >> 16));
+}
+
+inline uint16_t servo_frame_get_u16(const uint8_t* bytes) {
+  return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+inline uint32_t servo_frame_get_u32(const uint8_t* bytes) {
+  return servo_frame_get_u16(bytes) | ((uint32_t)servo_frame_get_u16(bytes + 2) << 16);
+}
+
+// Writes SERVO_FRAME_SIZE bytes
+inline void servo_frame_encode(const ServoFrame& frame, uint8_t bytes[SERVO_FRAME_SIZE]) {
+  bytes[0] = SERVO_FRAME_PULSES;
+  bytes[1] = frame.device;
+  servo_frame_put_u32(bytes + 2, frame.seq);
+  servo_frame_put_u16(bytes + 6, frame.x_us);
+  servo_frame_put_u16(bytes + 8, frame.y_us);
+}
+
+// Returns false if bytes is not a frame
+inline bool servo_frame_decode(const uint8_t* bytes, size_t length, ServoFrame& frame) {
+  if (length != SERVO_FRAME_SIZE || bytes[0] != SERVO_FRAME_PULSES) return false;
+  frame.device = bytes[1];
+  frame.seq = servo_frame_get_u32(bytes + 2);
+  frame.x_us = servo_frame_get_u16(bytes + 6);
+  frame.y_us = servo_frame_get_u16(bytes + 8);
+  return true;
+}
+
+// Writes SERVO_FRAME_TEXT_SIZE characters, terminator included
+inline void servo_frame_encode_text(const ServoFrame& frame, char text[SERVO_FRAME_TEXT_SIZE]) {
+  uint8_t bytes[SERVO_FRAME_SIZE];
+  servo_frame_encode(frame, bytes);
+  base64_encode(bytes, sizeof(bytes), text);
+}
+
+inline bool servo_frame_decode_text(const char* text, ServoFrame& frame) {
+  uint8_t bytes[SERVO_FRAME_SIZE];
+  return servo_frame_decode(bytes, base64_decode(text, bytes, sizeof(bytes)), frame);
+}
+
+#endif
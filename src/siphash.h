@@ -0,0 +1,71 @@
+/**
+ * Description:     SipHash-2-4 message authentication.
+ *
+ *                  A keyed 64-bit MAC that is fast on short inputs, which is
+ *                  what authenticating a few-byte control packet needs. Bytes
+ *                  are read little-endian, as in the reference
+ *                  implementation, so tags match on every platform and in the
+ *                  web app's JavaScript version.
+ *
+ *                  Header-only so the host tools can share it.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+const uint8_t SIPHASH_KEY_SIZE = 16;
+
+inline uint64_t siphash_read_u64(const uint8_t* bytes) {
+  uint64_t value = 0;
+  for (uint8_t i = 0; i < 8; i++) value |= (uint64_t)bytes[i] << (8 * i);
+  return value;
+}
+
+inline uint64_t siphash_rotl(uint64_t value, uint8_t bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+inline void siphash_round(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+  v0 += v1; v1 = siphash_rotl(v1, 13); v1 ^= v0; v0 = siphash_rotl(v0, 32);
+  v2 += v3; v3 = siphash_rotl(v3, 16); v3 ^= v2;
+  v0 += v3; v3 = siphash_rotl(v3, 21); v3 ^= v0;
+  v2 += v1; v1 = siphash_rotl(v1, 17); v1 ^= v2; v2 = siphash_rotl(v2, 32);
+}
+
+inline uint64_t siphash24(const uint8_t key[SIPHASH_KEY_SIZE], const uint8_t* data, size_t length) {
+  uint64_t k0 = siphash_read_u64(key);
+  uint64_t k1 = siphash_read_u64(key + 8);
+  uint64_t v0 = k0 ^ 0x736f6d6570736575ULL;
+  uint64_t v1 = k1 ^ 0x646f72616e646f6dULL;
+  uint64_t v2 = k0 ^ 0x6c7967656e657261ULL;
+  uint64_t v3 = k1 ^ 0x7465646279746573ULL;
+
+  size_t whole = length & ~(size_t)7;
+  for (size_t i = 0; i < whole; i += 8) {
+    uint64_t m = siphash_read_u64(data + i);
+    v3 ^= m;
+    siphash_round(v0, v1, v2, v3);
+    siphash_round(v0, v1, v2, v3);
+    v0 ^= m;
+  }
+
+  // Last block: remaining bytes, length in the top byte
+  uint64_t last = (uint64_t)(length & 0xFF) << 56;
+  for (size_t i = whole; i < length; i++) last |= (uint64_t)data[i] << (8 * (i - whole));
+  v3 ^= last;
+  siphash_round(v0, v1, v2, v3);
+  siphash_round(v0, v1, v2, v3);
+  v0 ^= last;
+
+  v2 ^= 0xFF;
+  for (uint8_t i = 0; i < 4; i++) siphash_round(v0, v1, v2, v3);
+  return v0 ^ v1 ^ v2 ^ v3;
+}
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * Description:     Fixed-capacity, allocation-free single-producer/single-
+ *                  consumer ring buffer.
+ *
+ *                  Exactly one task may call push() and exactly one other task
+ *                  may call pop(). Neither side ever blocks or takes a lock:
+ *                  each index is only written by its owner and published with
+ *                  release/acquire ordering, so the slot contents are visible
+ *                  to the consumer before the new head is.
+ *
+ *                  Plain C++ with no Arduino dependencies so it can be built
+ *                  and exercised on the host.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stdint.h>
+#include "cache_line.h"
+
+template <typename T, uint32_t CAPACITY>
+class SpscRing {
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+public:
+  SpscRing() : head(0), tail(0) {}
+
+  // Producer only. Returns false without modifying the ring when it is full.
+  bool push(const T& item) {
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == CAPACITY) return false;
+    slots[h & (CAPACITY - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns false when the ring is empty.
+  bool pop(T& item) {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (head.load(std::memory_order_acquire) == t) return false;
+    item = slots[t & (CAPACITY - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Snapshot of the number of queued items. Exact only from the consumer.
+  uint32_t size(void) const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  bool empty(void) const { return size() == 0; }
+
+  static uint32_t capacity(void) { return CAPACITY; }
+
+private:
+  // Free-running indices; only their low bits select a slot. Each starts a
+  // cache line of its own so the producer and consumer don't false-share.
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> head;
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> tail;
+  T slots[CAPACITY];
+};
+
+#endif
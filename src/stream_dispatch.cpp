@@ -0,0 +1,192 @@
+/**
+ * Description:     Path dispatch for the multiplexed RTDB stream
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <string.h>
+#include "stream_dispatch.h"
+#include "device_table.h"
+
+// Newest frame or pose sequence number accepted per device, and whether
+// there is one
+static uint32_t last_frame_seq[DEVICE_COUNT];
+static bool frame_seen[DEVICE_COUNT];
+
+// Pose leaves, and the gimbal's own angle leaves, read so far in the current
+// stream event, per POSE_PATHS entry
+const uint8_t POSE_HAS_X = 1;
+const uint8_t POSE_HAS_Y = 2;
+const uint8_t POSE_HAS_SEQ = 4;
+const uint8_t POSE_COMPLETE = POSE_HAS_X | POSE_HAS_Y | POSE_HAS_SEQ;
+const uint8_t POSE_HAS_X_ANGLE = 8;
+const uint8_t POSE_HAS_Y_ANGLE = 16;
+
+struct PendingPose {
+  uint8_t fields;
+  int x_angle;
+  int y_angle;
+  uint32_t seq;
+  int axis_x_angle;         // from the gimbal's x_angle row
+  int axis_y_angle;         // from the gimbal's y_angle row
+};
+
+static PendingPose pending_poses[POSE_PATH_COUNT];
+
+// A pose packs each angle into 16 bits, in tenths of a degree
+constexpr bool servo_row_fits_pose(const DeviceChannel& entry) {
+  return entry.kind != DEVICE_KIND_SERVO ||
+         (entry.min_value >= 0 && entry.max_value * POSE_UNITS_PER_DEGREE <= INT16_MAX);
+}
+
+constexpr bool servo_rows_fit_pose(uint8_t row = 0) {
+  return row >= DEVICE_CHANNEL_COUNT || (servo_row_fits_pose(DEVICE_TABLE[row]) && servo_rows_fit_pose(row + 1));
+}
+
+static_assert(servo_rows_fit_pose(), "Servo angles must fit in 16 bits as tenths of a degree to be sent as a pose");
+
+static int clamp_to_row(uint8_t row, int value) {
+  const DeviceChannel& entry = DEVICE_TABLE[row];
+  if (value > entry.max_value) return entry.max_value;
+  if (value < entry.min_value) return entry.min_value;
+  return value;
+}
+
+// Same for an angle in tenths of a degree
+static int16_t clamp_tenths_to_row(uint8_t row, int tenths) {
+  const DeviceChannel& entry = DEVICE_TABLE[row];
+  if (tenths > entry.max_value * POSE_UNITS_PER_DEGREE) return (int16_t)(entry.max_value * POSE_UNITS_PER_DEGREE);
+  if (tenths < entry.min_value * POSE_UNITS_PER_DEGREE) return (int16_t)(entry.min_value * POSE_UNITS_PER_DEGREE);
+  return (int16_t)tenths;
+}
+
+// Clamps value to the row's range and emits it
+static void dispatch_row(uint8_t row, int value, uint32_t timestamp_us, CommandSink sink) {
+  const DeviceChannel& entry = DEVICE_TABLE[row];
+  Command command;
+  command.device = entry.device;
+  command.channel = entry.channel;
+  command.value = clamp_to_row(row, value);
+  command.timestamp_us = timestamp_us;
+  sink(command);
+}
+
+bool dispatch_stream_value(const char* path, int value, uint32_t timestamp_us, CommandSink sink) {
+  uint8_t row = device_row_for_path(path);
+  if (row == DEVICE_NO_ROW) return false;
+  dispatch_row(row, value, timestamp_us, sink);
+  return true;
+}
+
+bool dispatch_device_value(uint8_t device, uint8_t channel, int value, uint32_t timestamp_us, CommandSink sink) {
+  uint8_t row = device_row_for_command(device, channel);
+  if (row == DEVICE_NO_ROW) return false;
+  dispatch_row(row, value, timestamp_us, sink);
+  return true;
+}
+
+// True if both channels of the device are servo axes
+static bool is_gimbal(uint8_t device) {
+  uint8_t x_row = device_row_for_command(device, CHANNEL_X);
+  uint8_t y_row = device_row_for_command(device, CHANNEL_Y);
+  return x_row != DEVICE_NO_ROW && y_row != DEVICE_NO_ROW &&
+         DEVICE_TABLE[x_row].kind == DEVICE_KIND_SERVO && DEVICE_TABLE[y_row].kind == DEVICE_KIND_SERVO;
+}
+
+bool dispatch_pose(uint8_t device, int x_tenths, int y_tenths, uint32_t seq, uint32_t timestamp_us, CommandSink sink) {
+  if (!is_gimbal(device)) return false;
+  if (frame_seen[device] && (int32_t)(seq - last_frame_seq[device]) <= 0) return false;
+  last_frame_seq[device] = seq;
+  frame_seen[device] = true;
+
+  Command command;
+  command.device = device;
+  command.channel = CHANNEL_POSE;
+  command.value = pose_value(clamp_tenths_to_row(device_row_for_command(device, CHANNEL_X), x_tenths),
+                             clamp_tenths_to_row(device_row_for_command(device, CHANNEL_Y), y_tenths));
+  command.timestamp_us = timestamp_us;
+  sink(command);
+  return true;
+}
+
+bool dispatch_servo_frame(const ServoFrame& frame, uint32_t timestamp_us, CommandSink sink) {
+  return dispatch_pose(frame.device, servo_pulse_us_to_tenths(frame.x_us), servo_pulse_us_to_tenths(frame.y_us),
+                       frame.seq, timestamp_us, sink);
+}
+
+bool dispatch_servo_frame_text(const char* path, const char* text, uint32_t timestamp_us, CommandSink sink) {
+  for (uint8_t i = 0; i < SERVO_FRAME_PATH_COUNT; i++) {
+    if (strcmp(path, SERVO_FRAME_PATHS[i].path) != 0) continue;
+    ServoFrame frame;
+    if (!servo_frame_decode_text(text, frame) || frame.device != SERVO_FRAME_PATHS[i].device) return false;
+    return dispatch_servo_frame(frame, timestamp_us, sink);
+  }
+  return false;
+}
+
+// Path of a gimbal's angle row, or "" if it has none
+static const char* axis_path(uint8_t device, uint8_t channel) {
+  uint8_t row = device_row_for_command(device, channel);
+  return row == DEVICE_NO_ROW ? "" : DEVICE_TABLE[row].path;
+}
+
+bool dispatch_pose_leaf(const char* path, int value) {
+  for (uint8_t i = 0; i < POSE_PATH_COUNT; i++) {
+    PendingPose& pose = pending_poses[i];
+    if (strcmp(path, axis_path(POSE_PATHS[i].device, CHANNEL_X)) == 0) {
+      pose.axis_x_angle = value;
+      pose.fields |= POSE_HAS_X_ANGLE;
+    }
+    else if (strcmp(path, axis_path(POSE_PATHS[i].device, CHANNEL_Y)) == 0) {
+      pose.axis_y_angle = value;
+      pose.fields |= POSE_HAS_Y_ANGLE;
+    }
+    else if (strcmp(path, POSE_PATHS[i].x) == 0) {
+      pose.x_angle = value;
+      pose.fields |= POSE_HAS_X;
+    }
+    else if (strcmp(path, POSE_PATHS[i].y) == 0) {
+      pose.y_angle = value;
+      pose.fields |= POSE_HAS_Y;
+    }
+    else if (strcmp(path, POSE_PATHS[i].seq) == 0) {
+      pose.seq = (uint32_t)value;
+      pose.fields |= POSE_HAS_SEQ;
+    }
+    else continue;
+    return true;
+  }
+  return false;
+}
+
+// A JSON pose angle (whole degrees) in tenths, clamped first so it cannot
+// overflow
+static int pose_leaf_tenths(uint8_t device, uint8_t channel, int angle) {
+  uint8_t row = device_row_for_command(device, channel);
+  return row == DEVICE_NO_ROW ? 0 : clamp_to_row(row, angle) * POSE_UNITS_PER_DEGREE;
+}
+
+void dispatch_pose_event_end(uint32_t timestamp_us, CommandSink sink) {
+  for (uint8_t i = 0; i < POSE_PATH_COUNT; i++) {
+    PendingPose& pose = pending_poses[i];
+    uint8_t device = POSE_PATHS[i].device;
+    // A whole pose is ordered by its seq and the angle leaves are not, so
+    // the pose decides. Either it is newer than what the gimbal took last,
+    // or the gimbal already has something newer (ex: a snapshot after a
+    // reconnect mid-drag, whose angles date from the last release).
+    if ((pose.fields & POSE_COMPLETE) == POSE_COMPLETE) {
+      dispatch_pose(device, pose_leaf_tenths(device, CHANNEL_X, pose.x_angle),
+                    pose_leaf_tenths(device, CHANNEL_Y, pose.y_angle), pose.seq, timestamp_us, sink);
+    }
+    else {
+      if (pose.fields & POSE_HAS_X_ANGLE) {
+        dispatch_device_value(device, CHANNEL_X, pose.axis_x_angle, timestamp_us, sink);
+      }
+      if (pose.fields & POSE_HAS_Y_ANGLE) {
+        dispatch_device_value(device, CHANNEL_Y, pose.axis_y_angle, timestamp_us, sink);
+      }
+    }
+    pose.fields = 0;
+  }
+}
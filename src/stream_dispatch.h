@@ -0,0 +1,97 @@
+/**
+ * Description:     Decodes values from the single multiplexed RTDB stream into
+ *                  commands for the device registered at each database path.
+ *
+ *                  The stream is opened on a parent path (the root by default)
+ *                  so one socket carries every device. The HAL resolves each
+ *                  event (put, patch or initial snapshot) into individual
+ *                  (path, value) pairs, which are looked up in the device
+ *                  table (device_table.h) here.
+ *
+ *                  Gimbals can also be driven by binary servo frames
+ *                  (servo_frame.h), from the LAN channel or as base64 text at
+ *                  a frame path, and by a JSON pose node holding both axes:
+ *
+ *                    /laser_servo/pose = {"x": 120, "y": 45, "seq": 1234}
+ *
+ *                  Frames and poses land here, share one sequence number per
+ *                  device and become a single CHANNEL_POSE command, so both
+ *                  axes start moving in the same servo period. A pose's
+ *                  leaves arrive one at a time, so they are collected until
+ *                  the end of their stream event; a pose is only dispatched
+ *                  when all three were written in that event. seq is a 32-bit
+ *                  serial number written as a signed integer.
+ *
+ *                  The gimbal's own x_angle and y_angle carry no sequence
+ *                  number, so in an event that also holds a complete pose
+ *                  (ex: the snapshot after a reconnect) they give way to it.
+ *                  Otherwise stale angles written at the last release would
+ *                  snap back a gimbal that newer poses have since moved.
+ *
+ *                  Network task only.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef STREAM_DISPATCH_H
+#define STREAM_DISPATCH_H
+
+#include "command.h"
+#include "servo_frame.h"
+
+// Receives each command decoded from a stream value
+typedef void (*CommandSink)(const Command& command);
+
+// Leaves of each gimbal's pose node
+struct PosePath {
+  const char* x;
+  const char* y;
+  const char* seq;
+  uint8_t device;
+};
+
+const PosePath POSE_PATHS[] = {
+  { "/camera_servo/pose/x", "/camera_servo/pose/y", "/camera_servo/pose/seq", DEVICE_CAMERA },
+  { "/laser_servo/pose/x",  "/laser_servo/pose/y",  "/laser_servo/pose/seq",  DEVICE_LASER },
+};
+
+const uint8_t POSE_PATH_COUNT = sizeof(POSE_PATHS) / sizeof(POSE_PATHS[0]);
+
+// Stream paths to watch for the pose nodes (x, y and seq of each)
+const uint8_t POSE_LEAF_COUNT = POSE_PATH_COUNT * 3;
+
+// Decodes a value at path into a command for the device registered there,
+// clamped to the device's range, and hands it to sink. Returns false if no
+// device is registered at path.
+bool dispatch_stream_value(const char* path, int value, uint32_t timestamp_us, CommandSink sink);
+
+// Same for a value addressed by device and channel (ex: from the LAN
+// channel). Returns false if no such channel is registered.
+bool dispatch_device_value(uint8_t device, uint8_t channel, int value, uint32_t timestamp_us, CommandSink sink);
+
+// Clamps both angles (tenths of a degree) to the gimbal's range and hands
+// them to sink as one pose command. Returns false if the device is not a
+// gimbal or seq is not newer than the last frame or pose accepted for it.
+bool dispatch_pose(uint8_t device, int x_tenths, int y_tenths, uint32_t seq, uint32_t timestamp_us, CommandSink sink);
+
+// Decodes a frame into a pose command, as dispatch_pose(), keeping its pulse
+// widths to the nearest tenth of a degree
+bool dispatch_servo_frame(const ServoFrame& frame, uint32_t timestamp_us, CommandSink sink);
+
+// Same for a base64 frame written to one of SERVO_FRAME_PATHS. Returns false
+// if path is not a frame path, text is not a frame for that path's gimbal or
+// the frame is stale.
+bool dispatch_servo_frame_text(const char* path, const char* text, uint32_t timestamp_us, CommandSink sink);
+
+// Collects a value at one of the POSE_PATHS leaves, or at one of those
+// gimbals' own angle paths. Returns false if path is neither.
+bool dispatch_pose_leaf(const char* path, int value);
+
+// Dispatches every pose completed by the stream event that just ended and
+// drops partial ones. A gimbal's angle paths from the same event give way to
+// its complete pose and are dispatched as single axes otherwise. Call once
+// after each event.
+void dispatch_pose_event_end(uint32_t timestamp_us, CommandSink sink);
+
+#endif
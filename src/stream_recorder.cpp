@@ -0,0 +1,99 @@
+/**
+ * Description:     Stream value ring and its console output
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/16/2026
+ */
+
+#include "stream_recorder.h"
+
+#ifdef STREAM_RECORDER
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include "spsc_ring.h"
+#include "hal/hal.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+// Longest path and text value kept, terminator included. Every watched path
+// fits; longer text is dropped rather than replayed truncated.
+const size_t RECORDER_MAX_PATH = 48;
+const size_t RECORDER_MAX_TEXT = 32;
+
+// Values that can wait for the logger task. A reconnect snapshot delivers
+// every watched path at once.
+const uint32_t RECORDER_RING_CAPACITY = 64;
+
+struct RecordedValue {
+  uint32_t time_us;
+  uint32_t event;
+  bool is_text;
+  int32_t value;
+  char path[RECORDER_MAX_PATH];
+  char text[RECORDER_MAX_TEXT];
+};
+
+static SpscRing<RecordedValue, RECORDER_RING_CAPACITY> recorder_ring;
+static std::atomic<uint32_t> dropped_values(0);
+static uint32_t event_number = 0;
+
+static bool copy_text(char* destination, size_t size, const char* text) {
+  size_t length = strlen(text);
+  if (length >= size) return false;
+  memcpy(destination, text, length + 1);
+  return true;
+}
+
+static void record(const char* path, bool is_text, int value, const char* text) {
+  RecordedValue recorded;
+  recorded.time_us = hal_micros();
+  recorded.event = event_number;
+  recorded.is_text = is_text;
+  recorded.value = value;
+  if (!copy_text(recorded.path, sizeof(recorded.path), path) ||
+      !copy_text(recorded.text, sizeof(recorded.text), is_text ? text : "") || !recorder_ring.push(recorded)) {
+    dropped_values.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+// ============================================================================
+//                                    API
+// ============================================================================
+void stream_recorder_value(const char* path, int value) {
+  record(path, false, value, NULL);
+}
+
+void stream_recorder_text(const char* path, const char* text) {
+  record(path, true, 0, text);
+}
+
+void stream_recorder_event_end(void) {
+  event_number++;
+}
+
+void stream_recorder_drain(void) {
+  static uint32_t reported_drops = 0;
+
+  char line[32 + RECORDER_MAX_PATH + RECORDER_MAX_TEXT];
+  RecordedValue recorded;
+  while (recorder_ring.pop(recorded)) {
+    int length = recorded.is_text
+      ? snprintf(line, sizeof(line), "REC %u %u %s \"%s\"\n", (unsigned)recorded.time_us,
+                 (unsigned)recorded.event, recorded.path, recorded.text)
+      : snprintf(line, sizeof(line), "REC %u %u %s %d\n", (unsigned)recorded.time_us,
+                 (unsigned)recorded.event, recorded.path, (int)recorded.value);
+    hal_console_write(line, length);
+  }
+
+  uint32_t dropped = dropped_values.load(std::memory_order_relaxed);
+  if (dropped != reported_drops) {
+    int length = snprintf(line, sizeof(line), "REC dropped %u\n", (unsigned)(dropped - reported_drops));
+    hal_console_write(line, length);
+    reported_drops = dropped;
+  }
+}
+
+#endif
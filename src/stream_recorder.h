@@ -0,0 +1,54 @@
+/**
+ * Description:     Device stream recorder, for replaying on the host.
+ *
+ *                  Every value the device stream delivers is queued with its
+ *                  hal_micros() timestamp and the number of the stream event
+ *                  that carried it. The logger task writes them to the
+ *                  console as
+ *
+ *                      REC <us> <event> <path> <value>
+ *
+ *                  with text values in double quotes. A console capture is
+ *                  therefore a recording as it stands: the host build
+ *                  replays its REC lines with HAL_REPLAY=<file> (see
+ *                  hal_host.cpp), and tools/stream_replay turns a replay into
+ *                  an actuation timeline and latency distribution.
+ *
+ *                  Values that find the ring full are dropped and reported
+ *                  as "REC dropped <count>", so an incomplete recording is
+ *                  never mistaken for a complete one.
+ *
+ *                  Build with -DSTREAM_RECORDER to enable it. Without it the
+ *                  calls below compile to nothing and no ring is allocated.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/16/2026
+ */
+
+#ifndef STREAM_RECORDER_H
+#define STREAM_RECORDER_H
+
+#include <stdint.h>
+
+#ifdef STREAM_RECORDER
+
+// Network task only
+void stream_recorder_value(const char* path, int value);
+void stream_recorder_text(const char* path, const char* text);
+
+// The stream event being delivered is complete. Network task only.
+void stream_recorder_event_end(void);
+
+// Write every queued value to the console. Logger task only.
+void stream_recorder_drain(void);
+
+#else
+
+inline void stream_recorder_value(const char* path, int value) { (void)path; (void)value; }
+inline void stream_recorder_text(const char* path, const char* text) { (void)path; (void)text; }
+inline void stream_recorder_event_end(void) {}
+inline void stream_recorder_drain(void) {}
+
+#endif
+
+#endif
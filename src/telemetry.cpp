@@ -0,0 +1,209 @@
+/**
+ * Description:     Telemetry sampling buffer and batch encoder
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "telemetry.h"
+#include "actuators.h"
+#include "motion_planner.h"
+#include "thermostat.h"
+#include "logger.h"
+#include "hal/hal.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+#define TELEMETRY_PATH "/telemetry"
+
+const uint32_t TELEMETRY_SAMPLE_PERIOD_MS = 1000;
+
+// Flush at least this often...
+const uint32_t TELEMETRY_FLUSH_INTERVAL_MS = 60000;
+
+// ...or as soon as the encoded batch would be this large
+const uint32_t TELEMETRY_FLUSH_BYTES = 1024;
+
+// Never more often than this, which also spaces out retries after a failed
+// upload
+const uint32_t TELEMETRY_MIN_FLUSH_INTERVAL_MS = 5000;
+
+// Hard cap on buffered samples. Only reached while the RTDB is down; the
+// buffered batch is then dropped.
+const uint8_t TELEMETRY_MAX_SAMPLES = 64;
+
+// Batches kept in the database before the oldest is overwritten
+const uint8_t TELEMETRY_BATCH_SLOTS = 8;
+
+
+// ============================================================================
+//                                  SOURCES
+// ============================================================================
+// TO ADD A NEW TELEMETRY CHANNEL: add a reader and one row to
+// TELEMETRY_SOURCES. Readers are called from the network task and must be
+// safe to call from there.
+struct TelemetrySource {
+  const char* name;
+  int32_t (*read)(void);
+};
+
+static int32_t read_temperature(void) { return thermostat_temperature(); }
+static int32_t read_heating(void) { return thermostat_heating() ? 1 : 0; }
+static int32_t read_camera_x(void) { return actuators_servo_angle(AXIS_CAMERA_X); }
+static int32_t read_camera_y(void) { return actuators_servo_angle(AXIS_CAMERA_Y); }
+static int32_t read_laser_x(void) { return actuators_servo_angle(AXIS_LASER_X); }
+static int32_t read_laser_y(void) { return actuators_servo_angle(AXIS_LASER_Y); }
+
+static const TelemetrySource TELEMETRY_SOURCES[] = {
+  { "temperature", read_temperature },
+  { "heating",     read_heating },
+  { "camera_x",    read_camera_x },
+  { "camera_y",    read_camera_y },
+  { "laser_x",     read_laser_x },
+  { "laser_y",     read_laser_y },
+};
+
+const uint8_t TELEMETRY_SOURCE_COUNT = sizeof(TELEMETRY_SOURCES) / sizeof(TELEMETRY_SOURCES[0]);
+
+// Worst case for one update: fixed fields, then per channel its name, every
+// value at full int32 width, and its latest/ entry
+const size_t TELEMETRY_JSON_SIZE = 160 + TELEMETRY_SOURCE_COUNT * (48 + TELEMETRY_MAX_SAMPLES * 12);
+
+
+// ============================================================================
+//                                   STATE
+// ============================================================================
+static int32_t samples[TELEMETRY_MAX_SAMPLES][TELEMETRY_SOURCE_COUNT];
+static uint8_t sample_count = 0;
+static uint32_t first_sample_ms = 0;
+static uint32_t last_sample_ms = 0;
+static bool sampled_once = false;
+
+// Encoded size of the batch so far, estimated as values are added
+static uint32_t batch_bytes = 0;
+
+static uint32_t last_flush_ms = 0;
+static uint32_t batch_seq = 0;
+static uint32_t dropped_batches = 0;
+
+// Last values written to latest/, so only changes are sent
+static int32_t published[TELEMETRY_SOURCE_COUNT];
+static bool published_once = false;
+
+static char json[TELEMETRY_JSON_SIZE];
+
+
+// Characters a value takes in the batch, including its separator
+static uint8_t encoded_length(int32_t value) {
+  uint8_t length = value < 0 ? 2 : 1;
+  uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+  while (magnitude >= 10) {
+    magnitude /= 10;
+    length++;
+  }
+  return length + 1;
+}
+
+// snprintf onto the end of json. Returns false once it no longer fits.
+static bool append(size_t& length, const char* format, ...) {
+  if (length >= sizeof(json)) return false;
+  va_list args;
+  va_start(args, format);
+  int written = vsnprintf(json + length, sizeof(json) - length, format, args);
+  va_end(args);
+  if (written < 0) return false;
+  length += written;
+  return length < sizeof(json);
+}
+
+static void take_sample(uint32_t now_ms) {
+  if (sample_count == 0) {
+    first_sample_ms = now_ms;
+    batch_bytes = 0;
+  }
+
+  int32_t* sample = samples[sample_count];
+  for (uint8_t i = 0; i < TELEMETRY_SOURCE_COUNT; i++) {
+    const TelemetrySource& source = TELEMETRY_SOURCES[i];
+    sample[i] = source.read();
+    batch_bytes += sample_count == 0 ? encoded_length(sample[i]) + 6 + strlen(source.name)
+                                     : encoded_length(sample[i] - samples[sample_count - 1][i]);
+  }
+  sample_count++;
+}
+
+// Builds the multi-path update for the buffered batch. Returns false if it
+// does not fit, which TELEMETRY_JSON_SIZE rules out.
+static bool encode_batch(void) {
+  uint32_t slot = batch_seq % TELEMETRY_BATCH_SLOTS;
+  size_t length = 0;
+  bool fits = append(length, "{\"head\":%u,\"batches/%u\":{\"seq\":%u,\"t0\":%u,\"dt\":%u,\"n\":%u",
+                     (unsigned)batch_seq, (unsigned)slot, (unsigned)batch_seq, (unsigned)first_sample_ms,
+                     (unsigned)TELEMETRY_SAMPLE_PERIOD_MS, (unsigned)sample_count);
+
+  for (uint8_t i = 0; i < TELEMETRY_SOURCE_COUNT && fits; i++) {
+    // Drop the run of unchanged samples at the end
+    uint8_t last = sample_count - 1;
+    while (last > 0 && samples[last][i] == samples[last - 1][i]) last--;
+
+    fits = append(length, ",\"%s\":[%ld", TELEMETRY_SOURCES[i].name, (long)samples[0][i]);
+    for (uint8_t s = 1; s <= last && fits; s++) {
+      fits = append(length, ",%ld", (long)(samples[s][i] - samples[s - 1][i]));
+    }
+    if (fits) fits = append(length, "]");
+  }
+  if (fits) fits = append(length, "}");
+
+  const int32_t* newest = samples[sample_count - 1];
+  for (uint8_t i = 0; i < TELEMETRY_SOURCE_COUNT && fits; i++) {
+    if (published_once && newest[i] == published[i]) continue;
+    fits = append(length, ",\"latest/%s\":%ld", TELEMETRY_SOURCES[i].name, (long)newest[i]);
+  }
+  if (fits) fits = append(length, "}");
+  return fits;
+}
+
+static void flush_batch(void) {
+  if (!encode_batch()) {
+    LOGGER_ERROR("Telemetry batch does not fit");
+    sample_count = 0;
+    return;
+  }
+  if (!hal_rtdb_update_json(TELEMETRY_PATH, json)) {
+    // Kept for the next flush, or dropped once the buffer fills
+    LOGGER_WARN("Failed to upload telemetry: %s", hal_net_error());
+    return;
+  }
+
+  memcpy(published, samples[sample_count - 1], sizeof(published));
+  published_once = true;
+  batch_seq++;
+  sample_count = 0;
+}
+
+void telemetry_tick(uint32_t now_ms, bool rtdb_up) {
+  if (!sampled_once || now_ms - last_sample_ms >= TELEMETRY_SAMPLE_PERIOD_MS) {
+    sampled_once = true;
+    last_sample_ms = now_ms;
+
+    if (sample_count == TELEMETRY_MAX_SAMPLES) {
+      dropped_batches++;
+      sample_count = 0;
+      LOGGER_WARN("Telemetry buffer full while offline. Dropped a batch (%u total)", (unsigned)dropped_batches);
+    }
+    take_sample(now_ms);
+  }
+
+  if (sample_count == 0 || !rtdb_up) return;
+  if (now_ms - last_flush_ms < TELEMETRY_MIN_FLUSH_INTERVAL_MS) return;
+  bool due = now_ms - last_flush_ms >= TELEMETRY_FLUSH_INTERVAL_MS || batch_bytes >= TELEMETRY_FLUSH_BYTES ||
+             sample_count == TELEMETRY_MAX_SAMPLES;
+  if (!due) return;
+
+  last_flush_ms = now_ms;
+  flush_batch();
+}
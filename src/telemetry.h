@@ -0,0 +1,43 @@
+/**
+ * Description:     Batched, delta-encoded telemetry uplink.
+ *
+ *                  Sensor readings and actuator positions are sampled on a
+ *                  fixed period into a static buffer, however fast the
+ *                  sources themselves change. The buffer goes up as ONE
+ *                  multi-path RTDB update, either every flush interval or as
+ *                  soon as its encoded size reaches a threshold, so both the
+ *                  request rate and the bytes per request stay bounded.
+ *
+ *                  Each update writes, under /telemetry:
+ *
+ *                    head                  sequence number of the newest batch
+ *                    batches/<slot>        the batch (slot = seq % slots)
+ *                    latest/<channel>      newest value of each channel that
+ *                                          changed since the last update
+ *
+ *                  A batch is {"seq":S,"t0":T,"dt":D,"n":N,"<channel>":[...]}:
+ *                  N samples taken D ms apart, the first at uptime T ms. Each
+ *                  channel array holds the first value followed by the change
+ *                  from one sample to the next. Trailing zero changes are left
+ *                  out, so a channel that held still for the whole batch is
+ *                  just [value]. Batches rotate through a fixed number of
+ *                  slots, so the database keeps a bounded history.
+ *
+ *                  Temperature is in tenths of a degree Celsius (-32768 when
+ *                  there is no reading) and servo positions in degrees.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// Sample the sources and flush if due. rtdb_up says whether a flush can be
+// attempted; while it is false samples are kept until the buffer is full.
+// Network task only.
+void telemetry_tick(uint32_t now_ms, bool rtdb_up);
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * Description:     Thermistor sampling and heating pad hysteresis control
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <atomic>
+#include <math.h>
+#include "thermostat.h"
+#include "analog_input.h"
+#include "logger.h"
+#include "hal/hal.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+const uint32_t THERMOSTAT_SAMPLE_PERIOD_US = 1000000 / ANALOG_OUTPUT_RATE_HZ;
+
+// Pad turns on below setpoint - hysteresis and off above setpoint + hysteresis
+const int16_t THERMOSTAT_HYSTERESIS = 5;
+
+// Hard limit, whatever the setpoint or mode
+const int16_t THERMOSTAT_MAX_TEMPERATURE = 500;
+
+// Minimum time between regulation switches
+const uint32_t THERMOSTAT_MIN_SWITCH_MS = 10000;
+
+// 10k NTC thermistor (B = 3950) from the ADC pin to ground, 10k series
+// resistor from the sensor enable pin (3.3 V when on) to the ADC pin
+const float THERMISTOR_NOMINAL_OHMS = 10000.0f;
+const float THERMISTOR_NOMINAL_KELVIN = 298.15f;
+const float THERMISTOR_BETA = 3950.0f;
+const float THERMISTOR_SERIES_OHMS = 10000.0f;
+const float THERMISTOR_SUPPLY_MV = 3300.0f;
+
+// Readings outside this band mean an open or shorted (or unpowered) sensor
+const uint32_t THERMISTOR_MIN_MV = 50;
+const uint32_t THERMISTOR_MAX_MV = 3250;
+
+
+static uint8_t heater_pin = 0;
+static uint8_t sensor_input = ANALOG_NO_INPUT;
+
+static std::atomic<bool> enabled(false);
+static std::atomic<int16_t> setpoint(0);
+static std::atomic<int16_t> temperature(THERMOSTAT_NO_READING);
+
+// Heater state, shared by the sampling timer and the actuator task
+static bool heater_on = false;
+static uint32_t last_switch_ms = 0;
+static HalSpinlock heater_lock = HAL_SPINLOCK_INIT;
+
+static bool read_celsius(float& celsius) {
+  uint32_t mv;
+  if (!analog_input_read_mv(sensor_input, mv)) return false;
+  if (mv < THERMISTOR_MIN_MV || mv > THERMISTOR_MAX_MV) return false;
+
+  float ohms = THERMISTOR_SERIES_OHMS * mv / (THERMISTOR_SUPPLY_MV - mv);
+  float inverse_kelvin = 1.0f / THERMISTOR_NOMINAL_KELVIN + logf(ohms / THERMISTOR_NOMINAL_OHMS) / THERMISTOR_BETA;
+  celsius = 1.0f / inverse_kelvin - 273.15f;
+  return true;
+}
+
+// Caller holds heater_lock. Only regulation switches start the minimum
+// switch interval, so a fail-safe or master switch change never delays the
+// regulation that follows it.
+static void set_heater(bool on, bool regulating, uint32_t now_ms) {
+  if (on == heater_on) return;
+  heater_on = on;
+  if (regulating) last_switch_ms = now_ms;
+  hal_gpio_write(heater_pin, on);
+}
+
+// Decides the heater state from the latest reading and settings
+static void evaluate(uint32_t now_ms) {
+  int16_t reading = temperature.load();
+  int16_t target = setpoint.load();
+  bool overheated = reading != THERMOSTAT_NO_READING && reading >= THERMOSTAT_MAX_TEMPERATURE;
+
+  hal_spin_lock(&heater_lock);
+  if (!enabled.load() || overheated) set_heater(false, false, now_ms);
+  else if (target <= 0) set_heater(true, false, now_ms);
+  else if (reading == THERMOSTAT_NO_READING) set_heater(false, false, now_ms);
+  else if (now_ms - last_switch_ms >= THERMOSTAT_MIN_SWITCH_MS) {
+    if (!heater_on && reading <= target - THERMOSTAT_HYSTERESIS) set_heater(true, true, now_ms);
+    else if (heater_on && reading >= target + THERMOSTAT_HYSTERESIS) set_heater(false, true, now_ms);
+  }
+  hal_spin_unlock(&heater_lock);
+}
+
+static void thermostat_sample(void* arg) {
+  (void)arg;
+  float celsius;
+  if (read_celsius(celsius)) temperature.store((int16_t)lroundf(celsius * 10.0f));
+  else temperature.store(THERMOSTAT_NO_READING);
+  evaluate(hal_millis());
+}
+
+void thermostat_begin(uint8_t heater, uint8_t sensor, bool on, int16_t target) {
+  heater_pin = heater;
+  sensor_input = analog_input_add(sensor);
+  if (sensor_input == ANALOG_NO_INPUT) LOGGER_ERROR("No analog input left for the thermostat");
+  enabled.store(on);
+  setpoint.store(target);
+
+  // Regulation may switch as soon as it has a reading
+  last_switch_ms = hal_millis() - THERMOSTAT_MIN_SWITCH_MS;
+  hal_gpio_output(heater_pin);
+  hal_gpio_write(heater_pin, false);
+  evaluate(hal_millis());
+
+  if (!hal_timer_start_periodic(thermostat_sample, NULL, THERMOSTAT_SAMPLE_PERIOD_US)) {
+    LOGGER_ERROR("Failed to start thermostat timer");
+  }
+}
+
+void thermostat_set_enabled(bool on) {
+  enabled.store(on);
+  evaluate(hal_millis());
+}
+
+void thermostat_set_setpoint(int16_t target) {
+  setpoint.store(target);
+  evaluate(hal_millis());
+}
+
+int16_t thermostat_temperature(void) {
+  return temperature.load();
+}
+
+bool thermostat_heating(void) {
+  hal_spin_lock(&heater_lock);
+  bool on = heater_on;
+  hal_spin_unlock(&heater_lock);
+  return on;
+}
@@ -0,0 +1,50 @@
+/**
+ * Description:     Closed-loop heating pad control.
+ *
+ *                  The thermistor is sampled continuously and filtered by
+ *                  analog_input; a 10 Hz timer converts the latest reading
+ *                  to a temperature. A hysteresis controller then drives
+ *                  the heating pad toward the setpoint, with a minimum time
+ *                  between switches to spare the pad and its relay. Every
+ *                  decision is made locally; the RTDB only supplies the
+ *                  setpoint.
+ *
+ *                  /heating_pad/state stays the master switch:
+ *                    off                  pad off
+ *                    on, setpoint 0       pad on (no regulation, as before)
+ *                    on, setpoint > 0     pad regulated around the setpoint
+ *
+ *                  While regulating, the pad fails safe (off) if the reading
+ *                  is missing or out of range, ex: the sensor is switched off.
+ *                  Above THERMOSTAT_MAX_TEMPERATURE it is off in every mode.
+ *
+ *                  Temperatures are in tenths of a degree Celsius.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#ifndef THERMOSTAT_H
+#define THERMOSTAT_H
+
+#include <stdint.h>
+
+// thermostat_temperature() with no valid reading
+const int16_t THERMOSTAT_NO_READING = INT16_MIN;
+
+// Configure the heater output, register the sensor with analog_input and
+// start the control timer. Setup code only, before analog_input_begin().
+void thermostat_begin(uint8_t heater_pin, uint8_t sensor_pin, bool enabled, int16_t setpoint);
+
+// Master switch (/heating_pad/state). Takes effect immediately.
+void thermostat_set_enabled(bool enabled);
+
+// Setpoint (/heating_pad/setpoint), 0 to disable regulation
+void thermostat_set_setpoint(int16_t setpoint);
+
+// Filtered temperature, or THERMOSTAT_NO_READING
+int16_t thermostat_temperature(void);
+
+bool thermostat_heating(void);
+
+#endif
@@ -0,0 +1,473 @@
+/**
+ * Description:     Fleet-scale load simulator against tools/rtdb_standin.
+ *
+ *                  Spins up a fleet of host-built firmware instances, each
+ *                  with its own chip id (HAL_CHIP_ID=sim-0001, ...) and so its
+ *                  own subtree /devices/<id> of the stand-in, and measures
+ *                  how stream fan-out and per-device latency hold up as the
+ *                  fleet grows.
+ *
+ *                  For each fleet size: every device's subtree is reset, the
+ *                  instances are started and timed until each has its stream
+ *                  up (it publishes /lan once it has). Then --count writes per
+ *                  device are made to <root>/state/heating_pad/state, spread
+ *                  evenly so the whole fleet is written once every
+ *                  --interval-ms. Each write is matched against the
+ *                  actuation trace (HAL_TRACE=1 output) of its own instance
+ *                  only, like tools/rtdb_loadgen does for one device. A
+ *                  write that shows up on another tower would be an
+ *                  unmatched actuation there, so those are counted too; with
+ *                  working namespaces there are none.
+ *
+ *                  Every instance holds one stream, and the stand-in checks
+ *                  each write against every stream, so the write ack time is
+ *                  the fan-out cost on the database side and the actuation
+ *                  latency is the end-to-end cost on the device side. Both
+ *                  are reported fleet-wide, along with the spread of each
+ *                  device's median and its worst p99.
+ *
+ *                  Usage:
+ *                    fleet_sim --firmware .pio/build/native/program
+ *                              [--port 9000] [--devices 1,10,100,300]
+ *                              [--count 20] [--interval-ms 200]
+ *                              [--settle-ms 2000] [--startup-ms 30000]
+ *                              [--per-device] [--verbose]
+ *
+ *                  Hundreds of instances need a raised process and file
+ *                  descriptor limit (ulimit -u, ulimit -n) on some systems.
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/16/2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+// Desired state path written (under the streamed /state), and the trace
+// output it drives on the host HAL
+const char* const WRITE_PATH = "/state/heating_pad/state";
+const char* const TRACE_KIND = "gpio";
+const unsigned TRACE_INDEX = 5;
+
+// Published by the firmware once its stream is up
+const char* const READY_PATH = "/lan";
+
+const int READY_POLL_MS = 50;
+
+struct Options {
+  std::string host = "127.0.0.1";
+  uint16_t port = 9000;
+  std::vector<unsigned> fleet_sizes = std::vector<unsigned>(1, 10);
+  unsigned count = 20;
+  unsigned interval_ms = 200;
+  unsigned settle_ms = 2000;
+  unsigned startup_ms = 30000;
+  std::string firmware;
+  bool per_device = false;
+  bool verbose = false;
+};
+
+struct Sample {
+  unsigned long long time_us;
+  int value;
+};
+
+// One firmware instance
+struct Device {
+  std::string id;
+  pid_t pid;
+  int trace_fd;
+  std::string partial_line;
+  std::vector<Sample> actuations;
+  std::vector<Sample> writes;
+  long long ready_ms;        // time from spawn to stream up, -1 if never
+  std::vector<unsigned long long> latencies;
+  unsigned superseded;
+  unsigned unmatched;        // actuations no write of this device explains
+};
+
+
+// ============================================================================
+//                                  HELPERS
+// ============================================================================
+static unsigned long long monotonic_us(void) {
+  return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int connect_to(const Options& options) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(options.port);
+  inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr);
+  if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    perror("connect");
+    exit(1);
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+// Sends one request on a keep-alive connection and waits for its response.
+// True for a 200 reply, whose body goes to reply if that is not NULL.
+static bool request(int fd, const Options& options, const char* method, const std::string& path,
+                    const std::string& body, std::string* reply) {
+  std::string text = std::string(method) + " " + path + ".json HTTP/1.1\r\nHost: " + options.host +
+                     "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+                     "\r\n\r\n" + body;
+  if (send(fd, text.data(), text.size(), MSG_NOSIGNAL) != (ssize_t)text.size()) return false;
+
+  std::string response;
+  char buffer[1024];
+  for (;;) {
+    size_t header_end = response.find("\r\n\r\n");
+    if (header_end != std::string::npos) {
+      size_t length_at = response.find("Content-Length:");
+      size_t length = length_at == std::string::npos ? 0 : strtoul(response.c_str() + length_at + 15, NULL, 10);
+      if (response.size() >= header_end + 4 + length) {
+        if (reply != NULL) *reply = response.substr(header_end + 4, length);
+        return response.compare(0, 12, "HTTP/1.1 200") == 0;
+      }
+    }
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) return false;
+    response.append(buffer, (size_t)n);
+  }
+}
+
+static std::string device_root(const Device& device) {
+  return "/devices/" + device.id;
+}
+
+// Parses "<us> <kind> <index> <value>" trace lines for the written output
+static void parse_trace_line(const char* line, std::vector<Sample>& samples) {
+  unsigned long long time_us;
+  char kind[16];
+  unsigned index;
+  int value;
+  if (sscanf(line, "%llu %15s %u %d", &time_us, kind, &index, &value) != 4) return;
+  if (strcmp(kind, TRACE_KIND) != 0 || index != TRACE_INDEX) return;
+  Sample sample = { time_us, value };
+  samples.push_back(sample);
+}
+
+static unsigned long long percentile(const std::vector<unsigned long long>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t index = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+
+// ============================================================================
+//                              FIRMWARE PROCESSES
+// ============================================================================
+static void spawn_firmware(const Options& options, Device& device) {
+  int pipe_fds[2];
+  if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+    perror("pipe");
+    exit(1);
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    std::string url = "http://" + options.host + ":" + std::to_string(options.port);
+    setenv("RTDB_URL", url.c_str(), 1);
+    setenv("HAL_TRACE", "1", 1);
+    setenv("HAL_CHIP_ID", device.id.c_str(), 1);
+    unsetenv("HAL_STORAGE_DIR");
+    dup2(pipe_fds[1], STDOUT_FILENO);
+    if (!options.verbose) {
+      int null_fd = open("/dev/null", O_WRONLY);
+      dup2(null_fd, STDERR_FILENO);
+    }
+    execl(options.firmware.c_str(), options.firmware.c_str(), (char*)NULL);
+    perror("exec");
+    _exit(127);
+  }
+  if (pid < 0) {
+    perror("fork");
+    exit(1);
+  }
+  close(pipe_fds[1]);
+  fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+  device.pid = pid;
+  device.trace_fd = pipe_fds[0];
+}
+
+// Reads every instance's trace until all of them have exited
+static void read_traces(std::vector<Device>* fleet) {
+  std::vector<struct pollfd> fds;
+  std::vector<size_t> owners;
+  char buffer[4096];
+
+  for (;;) {
+    fds.clear();
+    owners.clear();
+    for (size_t i = 0; i < fleet->size(); i++) {
+      if ((*fleet)[i].trace_fd < 0) continue;
+      struct pollfd pfd = { (*fleet)[i].trace_fd, POLLIN, 0 };
+      fds.push_back(pfd);
+      owners.push_back(i);
+    }
+    if (fds.empty()) return;
+    if (poll(&fds[0], fds.size(), 100) <= 0) continue;
+
+    for (size_t f = 0; f < fds.size(); f++) {
+      if (fds[f].revents == 0) continue;
+      Device& device = (*fleet)[owners[f]];
+      ssize_t n = read(device.trace_fd, buffer, sizeof(buffer));
+      if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+        close(device.trace_fd);
+        device.trace_fd = -1;
+        continue;
+      }
+      if (n < 0) continue;
+
+      device.partial_line.append(buffer, (size_t)n);
+      size_t start = 0;
+      for (size_t end; (end = device.partial_line.find('\n', start)) != std::string::npos; start = end + 1) {
+        parse_trace_line(device.partial_line.c_str() + start, device.actuations);
+      }
+      device.partial_line.erase(0, start);
+    }
+  }
+}
+
+// Waits until every instance has published READY_PATH or the startup time
+// runs out
+static void wait_ready(int fd, const Options& options, std::vector<Device>& fleet, unsigned long long spawn_us) {
+  unsigned long long deadline_us = spawn_us + (unsigned long long)options.startup_ms * 1000;
+  size_t waiting = fleet.size();
+  while (waiting > 0 && monotonic_us() < deadline_us) {
+    for (size_t i = 0; i < fleet.size(); i++) {
+      if (fleet[i].ready_ms >= 0) continue;
+      std::string lan;
+      if (request(fd, options, "GET", device_root(fleet[i]) + READY_PATH, "", &lan) && lan != "null") {
+        fleet[i].ready_ms = (long long)((monotonic_us() - spawn_us) / 1000);
+        waiting--;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(READY_POLL_MS));
+  }
+}
+
+// Matches each write to the first time the device's output reached the
+// written value. Once the output shows a later write's value, the write was
+// superseded. Actuations left over after matching were not caused by any
+// write of this device.
+static void match_writes(Device& device) {
+  const std::vector<Sample>& writes = device.writes;
+  const std::vector<Sample>& actuations = device.actuations;
+  std::vector<bool> explained(actuations.size(), false);
+  size_t cursor = 0;
+  device.superseded = 0;
+
+  for (size_t w = 0; w < writes.size(); w++) {
+    while (cursor < actuations.size() && actuations[cursor].time_us < writes[w].time_us) cursor++;
+
+    bool matched = false;
+    for (size_t a = cursor; a < actuations.size(); a++) {
+      if (actuations[a].value == writes[w].value) {
+        device.latencies.push_back(actuations[a].time_us - writes[w].time_us);
+        explained[a] = true;
+        matched = true;
+        break;
+      }
+      bool moved_on = false;
+      for (size_t n = w + 1; n < writes.size() && writes[n].time_us <= actuations[a].time_us; n++) {
+        if (writes[n].value == actuations[a].value) moved_on = true;
+      }
+      if (moved_on) break;
+    }
+    if (!matched) device.superseded++;
+  }
+
+  // Anything before the first write is the instance starting up
+  device.unmatched = 0;
+  for (size_t a = 0; a < actuations.size(); a++) {
+    if (!explained[a] && (writes.empty() || actuations[a].time_us >= writes[0].time_us)) device.unmatched++;
+  }
+  std::sort(device.latencies.begin(), device.latencies.end());
+}
+
+
+// ============================================================================
+//                                 FLEET RUN
+// ============================================================================
+static void run_fleet(const Options& options, unsigned size) {
+  std::vector<Device> fleet(size);
+  int fd = connect_to(options);
+
+  // Known starting value in each subtree, delivered in the initial snapshot
+  for (unsigned i = 0; i < size; i++) {
+    char id[16];
+    snprintf(id, sizeof(id), "sim-%04u", i + 1);
+    fleet[i].id = id;
+    fleet[i].pid = -1;
+    fleet[i].trace_fd = -1;
+    fleet[i].ready_ms = -1;
+    const char* reset = "{\"state\":{\"heating_pad\":{\"state\":0}}}";
+    if (!request(fd, options, "PUT", device_root(fleet[i]), reset, NULL)) {
+      fprintf(stderr, "Reset of %s failed\n", id);
+      exit(1);
+    }
+  }
+
+  unsigned long long spawn_us = monotonic_us();
+  for (unsigned i = 0; i < size; i++) spawn_firmware(options, fleet[i]);
+  std::thread reader(read_traces, &fleet);
+  wait_ready(fd, options, fleet, spawn_us);
+
+  // Spread the writes so the whole fleet is written once per interval
+  std::vector<unsigned long long> ack_us;
+  double spacing_us = options.interval_ms * 1000.0 / size;
+  unsigned long long start_us = monotonic_us();
+  for (unsigned round = 0; round < options.count; round++) {
+    for (unsigned i = 0; i < size; i++) {
+      unsigned long long due_us = start_us + (unsigned long long)((round * size + i) * spacing_us);
+      unsigned long long now_us = monotonic_us();
+      if (due_us > now_us) std::this_thread::sleep_for(std::chrono::microseconds(due_us - now_us));
+
+      Sample write = { monotonic_us(), (int)((round + 1) % 2) };
+      if (!request(fd, options, "PUT", device_root(fleet[i]) + WRITE_PATH, std::to_string(write.value), NULL)) {
+        fprintf(stderr, "Write to %s failed\n", fleet[i].id.c_str());
+        exit(1);
+      }
+      ack_us.push_back(monotonic_us() - write.time_us);
+      fleet[i].writes.push_back(write);
+    }
+  }
+  unsigned long long send_duration_us = monotonic_us() - start_us;
+  std::this_thread::sleep_for(std::chrono::milliseconds(options.settle_ms));
+
+  for (unsigned i = 0; i < size; i++) kill(fleet[i].pid, SIGTERM);
+  for (unsigned i = 0; i < size; i++) waitpid(fleet[i].pid, NULL, 0);
+  reader.join();
+
+  for (unsigned i = 0; i < size; i++) request(fd, options, "DELETE", device_root(fleet[i]), "", NULL);
+  close(fd);
+
+  // Fleet-wide and per-device results
+  std::vector<unsigned long long> latencies;
+  std::vector<unsigned long long> device_p50;
+  std::vector<long long> ready_ms;
+  unsigned long long worst_p99 = 0;
+  unsigned superseded = 0;
+  unsigned unmatched = 0;
+  unsigned up = 0;
+  for (unsigned i = 0; i < size; i++) {
+    Device& device = fleet[i];
+    match_writes(device);
+    latencies.insert(latencies.end(), device.latencies.begin(), device.latencies.end());
+    superseded += device.superseded;
+    unmatched += device.unmatched;
+    if (device.ready_ms >= 0) {
+      up++;
+      ready_ms.push_back(device.ready_ms);
+    }
+    if (!device.latencies.empty()) {
+      device_p50.push_back(percentile(device.latencies, 0.50));
+      worst_p99 = std::max(worst_p99, percentile(device.latencies, 0.99));
+    }
+    if (options.per_device) {
+      printf("  %s  ready %lld ms  actuated %zu  superseded %u  unmatched %u  p50 %llu  p99 %llu  max %llu\n",
+             device.id.c_str(), device.ready_ms, device.latencies.size(), device.superseded, device.unmatched,
+             percentile(device.latencies, 0.50), percentile(device.latencies, 0.99),
+             percentile(device.latencies, 1.0));
+    }
+  }
+  std::sort(latencies.begin(), latencies.end());
+  std::sort(ack_us.begin(), ack_us.end());
+  std::sort(device_p50.begin(), device_p50.end());
+  std::sort(ready_ms.begin(), ready_ms.end());
+  size_t writes = ack_us.size();
+
+  printf("devices         %u (%u streams up, all up after %lld ms)\n", size, up,
+         ready_ms.empty() ? -1LL : ready_ms.back());
+  printf("writes          %zu (%.1f/s)\n", writes, writes * 1e6 / (double)send_duration_us);
+  printf("actuated        %zu\n", latencies.size());
+  printf("superseded      %u\n", superseded);
+  printf("unmatched       %u\n", unmatched);
+  printf("write ack  us   p50 %llu  p90 %llu  p99 %llu  max %llu\n",
+         percentile(ack_us, 0.50), percentile(ack_us, 0.90), percentile(ack_us, 0.99), percentile(ack_us, 1.0));
+  printf("actuation  us   p50 %llu  p90 %llu  p99 %llu  max %llu\n",
+         percentile(latencies, 0.50), percentile(latencies, 0.90), percentile(latencies, 0.99),
+         percentile(latencies, 1.0));
+  printf("device p50 us   min %llu  median %llu  max %llu  (worst device p99 %llu)\n\n",
+         percentile(device_p50, 0.0), percentile(device_p50, 0.50), percentile(device_p50, 1.0), worst_p99);
+  fflush(stdout);
+}
+
+
+// ============================================================================
+//                                    MAIN
+// ============================================================================
+static void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s --firmware PATH [--host H] [--port N] [--devices N[,N...]]\n"
+          "          [--count N] [--interval-ms N] [--settle-ms N] [--startup-ms N]\n"
+          "          [--per-device] [--verbose]\n", program);
+  exit(2);
+}
+
+// "1,10,100" -> {1, 10, 100}
+static std::vector<unsigned> parse_sizes(const char* text) {
+  std::vector<unsigned> sizes;
+  for (const char* at = text; *at != '\0';) {
+    char* end;
+    unsigned long size = strtoul(at, &end, 10);
+    if (end == at || size == 0) return std::vector<unsigned>();
+    sizes.push_back((unsigned)size);
+    at = *end == ',' ? end + 1 : end;
+    if (*end != ',' && *end != '\0') return std::vector<unsigned>();
+  }
+  return sizes;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--per-device" || arg == "--verbose") {
+      (arg == "--verbose" ? options.verbose : options.per_device) = true;
+      continue;
+    }
+    if (i + 1 >= argc) usage(argv[0]);
+    if (arg == "--host") options.host = argv[++i];
+    else if (arg == "--port") options.port = (uint16_t)atoi(argv[++i]);
+    else if (arg == "--devices") options.fleet_sizes = parse_sizes(argv[++i]);
+    else if (arg == "--count") options.count = (unsigned)atoi(argv[++i]);
+    else if (arg == "--interval-ms") options.interval_ms = (unsigned)atoi(argv[++i]);
+    else if (arg == "--settle-ms") options.settle_ms = (unsigned)atoi(argv[++i]);
+    else if (arg == "--startup-ms") options.startup_ms = (unsigned)atoi(argv[++i]);
+    else if (arg == "--firmware") options.firmware = argv[++i];
+    else usage(argv[0]);
+  }
+  if (options.firmware.empty() || options.fleet_sizes.empty() || options.count == 0) usage(argv[0]);
+
+  signal(SIGPIPE, SIG_IGN);
+  for (size_t i = 0; i < options.fleet_sizes.size(); i++) run_fleet(options, options.fleet_sizes[i]);
+  return 0;
+}
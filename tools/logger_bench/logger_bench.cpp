@@ -0,0 +1,114 @@
+/**
+ * Description:     Per-call cost of the ring-buffered logger on the host.
+ *
+ *                  Times LOGGER_INFO with room in the ring (the normal case),
+ *                  with the ring full (the line is dropped), and with several
+ *                  producer threads at once. The drain itself is not timed;
+ *                  that cost lands on the logger task. For comparison it
+ *                  prints how long the same line takes to leave a 115200 baud
+ *                  UART, which is what a blocking Serial.printf waits for
+ *                  once the TX FIFO is full.
+ *
+ *                  Console output (the drained lines) goes to /dev/null.
+ *
+ *                  Usage:
+ *                    logger_bench [--calls 200000] [--threads 4]
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logger.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double ns_per_call(Clock::duration elapsed, uint32_t calls) {
+  return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+}
+
+// Calls LOGGER_INFO `calls` times, draining (untimed) whenever the ring fills
+static Clock::duration time_enqueue(uint32_t calls) {
+  Clock::duration total = Clock::duration::zero();
+  uint32_t done = 0;
+  while (done < calls) {
+    uint32_t batch = std::min(calls - done, LOGGER_RING_CAPACITY);
+    Clock::time_point start = Clock::now();
+    for (uint32_t i = 0; i < batch; i++) LOGGER_INFO("Stream read failed: %s (%u)", "connection lost", done + i);
+    total += Clock::now() - start;
+    logger_drain();
+    done += batch;
+  }
+  return total;
+}
+
+// Calls LOGGER_INFO against a full ring
+static Clock::duration time_drop(uint32_t calls) {
+  for (uint32_t i = 0; i < LOGGER_RING_CAPACITY; i++) LOGGER_INFO("filler %u", i);
+  Clock::time_point start = Clock::now();
+  for (uint32_t i = 0; i < calls; i++) LOGGER_INFO("Stream read failed: %s (%u)", "connection lost", i);
+  Clock::duration elapsed = Clock::now() - start;
+  logger_drain();
+  return elapsed;
+}
+
+// Producers log concurrently while this thread drains
+static Clock::duration time_contended(uint32_t calls, uint32_t threads) {
+  std::vector<std::thread> producers;
+  std::vector<Clock::duration> elapsed(threads);
+  volatile bool producing = true;
+
+  for (uint32_t t = 0; t < threads; t++) {
+    producers.push_back(std::thread([t, calls, threads, &elapsed]() {
+      Clock::time_point start = Clock::now();
+      for (uint32_t i = 0; i < calls / threads; i++) LOGGER_INFO("producer %u line %u", t, i);
+      elapsed[t] = Clock::now() - start;
+    }));
+  }
+  std::thread drainer([&producing]() {
+    while (producing) {
+      logger_drain();
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  });
+
+  for (size_t t = 0; t < producers.size(); t++) producers[t].join();
+  producing = false;
+  drainer.join();
+  logger_drain();
+
+  Clock::duration total = Clock::duration::zero();
+  for (uint32_t t = 0; t < threads; t++) total += elapsed[t];
+  return total;
+}
+
+int main(int argc, char** argv) {
+  uint32_t calls = 200000;
+  uint32_t threads = 4;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--calls") == 0) calls = strtoul(argv[i + 1], NULL, 10);
+    else if (strcmp(argv[i], "--threads") == 0) threads = strtoul(argv[i + 1], NULL, 10);
+  }
+  if (calls == 0 || threads == 0) {
+    fprintf(stderr, "Usage: logger_bench [--calls 200000] [--threads 4]\n");
+    return 1;
+  }
+
+  if (freopen("/dev/null", "w", stderr) == NULL) return 1;
+
+  printf("enqueue:             %8.1f ns/call\n", ns_per_call(time_enqueue(calls), calls));
+  printf("ring full (dropped): %8.1f ns/call\n", ns_per_call(time_drop(calls), calls));
+  printf("%u producers:         %8.1f ns/call\n", threads, ns_per_call(time_contended(calls, threads), calls));
+  printf("dropped lines:       %8u\n", logger_dropped());
+
+  // 10 bits per byte on the wire
+  const size_t line_length = strlen("      1234 I Stream read failed: connection lost (123)\n");
+  printf("115200 baud UART:    %8.1f ns/line (%u bytes)\n", line_length * 10 * 1e9 / 115200, (unsigned)line_length);
+  return 0;
+}
@@ -0,0 +1,482 @@
+/**
+ * Description:     Load generator for end-to-end latency benchmarking against
+ *                  tools/rtdb_standin.
+ *
+ *                  Writes bursts of values to one device path over the RTDB
+ *                  REST API and matches each write against the host
+ *                  firmware's actuation trace (HAL_TRACE=1 output) to report
+ *                  command-to-actuation latency percentiles. Both sides
+ *                  timestamp with CLOCK_MONOTONIC, so they line up as long as
+ *                  everything runs on the same machine.
+ *
+ *                  A write counts as actuated when the output it maps to
+ *                  first takes the written value after the write was sent.
+ *                  Writes superseded before that happens (ex: coalesced by
+ *                  the firmware) are reported separately. For servo paths the
+ *                  latency includes the motion planner's travel time and the
+ *                  wait for the next 20 ms PWM period.
+ *
+ *                  Servo writes can also be sent as binary servo frames
+ *                  (src/servo_frame.h), with the other axis held at 90:
+ *                  --frame writes each one base64-encoded to the gimbal's
+ *                  frame path, --lan sends it as an authenticated UDP packet
+ *                  over the firmware's LAN control channel
+ *                  (src/lan_control.h), using the address and session key
+ *                  the firmware publishes to /lan. Running the same path in
+ *                  each mode compares them.
+ *
+ *                  --path is relative to the desired state the firmware
+ *                  streams, /devices/<id>/state; the spawned firmware gets
+ *                  --device as its chip id (HAL_CHIP_ID).
+ *
+ *                  Usage:
+ *                    rtdb_loadgen --firmware .pio/build/native/program
+ *                                 [--port 9000] [--path /heating_pad/state]
+ *                                 [--count 200] [--burst 1] [--interval-ms 50]
+ *                                 [--settle-ms 1000] [--frame | --lan]
+ *                                 [--device host]
+ *                    rtdb_loadgen --trace trace.txt ...   (firmware started
+ *                                 separately with its stdout in trace.txt)
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "command.h"
+#include "lan_packet.h"
+#include "servo_frame.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+// Trace output each device path drives, as printed by the host HAL
+struct PathOutput {
+  const char* path;
+  const char* kind;     // "gpio" or "servo"
+  unsigned index;       // pin or servo channel
+  bool binary;          // on/off device
+  uint8_t device;       // DeviceId and channel, for LAN packets
+  uint8_t channel;
+};
+
+static const PathOutput PATH_OUTPUTS[] = {
+  { "/heating_pad/state",        "gpio",  5,  true,  DEVICE_HEATING_PAD,        CHANNEL_STATE },
+  { "/temperature_sensor/state", "gpio",  18, true,  DEVICE_TEMPERATURE_SENSOR, CHANNEL_STATE },
+  { "/camera_servo/x_angle",     "servo", 0,  false, DEVICE_CAMERA,             CHANNEL_X },
+  { "/camera_servo/y_angle",     "servo", 1,  false, DEVICE_CAMERA,             CHANNEL_Y },
+  { "/laser_servo/x_angle",      "servo", 2,  false, DEVICE_LASER,              CHANNEL_X },
+  { "/laser_servo/y_angle",      "servo", 3,  false, DEVICE_LASER,              CHANNEL_Y },
+};
+
+// Desired state the firmware streams, under its device root. Its uplinks
+// (ex: /lan) are siblings.
+const std::string DESIRED_STATE_PATH = "/state";
+
+// Time for the spawned firmware to boot and open its stream
+const int FIRMWARE_STARTUP_MS = 1000;
+
+struct Options {
+  std::string host = "127.0.0.1";
+  uint16_t port = 9000;
+  std::string path = "/heating_pad/state";
+  unsigned count = 200;
+  unsigned burst = 1;
+  unsigned interval_ms = 50;
+  unsigned settle_ms = 1000;
+  std::string firmware;
+  std::string trace_file;
+  std::string device = "host";
+  bool frame = false;
+  bool lan = false;
+};
+
+// Where and how to reach the firmware's LAN control channel
+struct LanTarget {
+  int fd;
+  struct sockaddr_in addr;
+  uint8_t key[SIPHASH_KEY_SIZE];
+};
+
+struct Sample {
+  unsigned long long time_us;
+  int value;
+};
+
+
+// ============================================================================
+//                                  HELPERS
+// ============================================================================
+static unsigned long long monotonic_us(void) {
+  return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int connect_to(const Options& options) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(options.port);
+  inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr);
+  if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    perror("connect");
+    exit(1);
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+// REST resource of a path under the device's root
+static std::string device_resource(const Options& options, const std::string& path) {
+  return "/devices/" + options.device + path + ".json";
+}
+
+// Sends one PUT of a desired state path on a keep-alive connection and waits
+// for its response
+static bool put_json(int fd, const Options& options, const std::string& path, const std::string& body) {
+  std::string request = "PUT " + device_resource(options, DESIRED_STATE_PATH + path) + " HTTP/1.1\r\nHost: " +
+                        options.host + "\r\nContent-Type: application/json\r\nContent-Length: " +
+                        std::to_string(body.size()) + "\r\n\r\n" + body;
+  if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return false;
+
+  std::string response;
+  char buffer[1024];
+  for (;;) {
+    size_t header_end = response.find("\r\n\r\n");
+    if (header_end != std::string::npos) {
+      size_t length_at = response.find("Content-Length:");
+      size_t length = length_at == std::string::npos ? 0 : strtoul(response.c_str() + length_at + 15, NULL, 10);
+      if (response.size() >= header_end + 4 + length) return response.compare(0, 12, "HTTP/1.1 200") == 0;
+    }
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) return false;
+    response.append(buffer, (size_t)n);
+  }
+}
+
+static bool put_value(int fd, const Options& options, const std::string& path, int value) {
+  return put_json(fd, options, path, std::to_string(value));
+}
+
+// Sends one GET on a keep-alive connection and returns the body, or an empty
+// string on failure
+static std::string get_json(int fd, const Options& options, const std::string& path) {
+  std::string request = "GET " + device_resource(options, path) + " HTTP/1.1\r\nHost: " + options.host + "\r\n\r\n";
+  if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) return "";
+
+  std::string response;
+  char buffer[1024];
+  for (;;) {
+    size_t header_end = response.find("\r\n\r\n");
+    if (header_end != std::string::npos) {
+      size_t length_at = response.find("Content-Length:");
+      size_t length = length_at == std::string::npos ? 0 : strtoul(response.c_str() + length_at + 15, NULL, 10);
+      if (response.size() >= header_end + 4 + length) return response.substr(header_end + 4, length);
+    }
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) return "";
+    response.append(buffer, (size_t)n);
+  }
+}
+
+// Value of "name" in a flat JSON object, without its quotes
+static std::string json_field(const std::string& json, const std::string& name) {
+  size_t at = json.find("\"" + name + "\":");
+  if (at == std::string::npos) return "";
+  at += name.size() + 3;
+  if (at < json.size() && json[at] == '"') at++;
+  size_t end = json.find_first_of("\",}", at);
+  return json.substr(at, end == std::string::npos ? std::string::npos : end - at);
+}
+
+// Reads /lan as published by the firmware and opens a UDP socket to it
+static bool open_lan(int fd, const Options& options, LanTarget& target) {
+  std::string lan = get_json(fd, options, "/lan");
+  std::string key = json_field(lan, "key");
+  if (json_field(lan, "transport") != "udp" || key.size() != 2 * SIPHASH_KEY_SIZE) return false;
+
+  for (uint8_t i = 0; i < SIPHASH_KEY_SIZE; i++) target.key[i] = (uint8_t)strtoul(key.substr(2 * i, 2).c_str(), NULL, 16);
+  memset(&target.addr, 0, sizeof(target.addr));
+  target.addr.sin_family = AF_INET;
+  target.addr.sin_port = htons((uint16_t)atoi(json_field(lan, "port").c_str()));
+  if (inet_pton(AF_INET, json_field(lan, "ip").c_str(), &target.addr.sin_addr) != 1) return false;
+
+  target.fd = socket(AF_INET, SOCK_DGRAM, 0);
+  return target.fd >= 0;
+}
+
+// Frame putting value on the output's axis and the other axis at 90. Sequence
+// numbers start from the clock, like the web app's, so they are newer than
+// any a previous run left behind.
+static ServoFrame frame_for(const PathOutput& output, int value) {
+  static uint32_t seq = (uint32_t)(std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count() / 10);
+
+  ServoFrame frame;
+  frame.device = output.device;
+  frame.seq = ++seq;
+  frame.x_us = servo_angle_to_pulse_us(output.channel == CHANNEL_X ? value : 90);
+  frame.y_us = servo_angle_to_pulse_us(output.channel == CHANNEL_Y ? value : 90);
+  return frame;
+}
+
+static const char* frame_path_for(const PathOutput& output) {
+  for (uint8_t i = 0; i < SERVO_FRAME_PATH_COUNT; i++) {
+    if (SERVO_FRAME_PATHS[i].device == output.device) return SERVO_FRAME_PATHS[i].path;
+  }
+  return NULL;
+}
+
+// Writes value as a base64 frame to the gimbal's frame path
+static bool put_frame_value(int fd, const Options& options, const PathOutput& output, int value) {
+  char text[SERVO_FRAME_TEXT_SIZE];
+  servo_frame_encode_text(frame_for(output, value), text);
+  return put_json(fd, options, frame_path_for(output), std::string("\"") + text + "\"");
+}
+
+// Sends value as a frame over the LAN channel
+static bool send_lan_value(LanTarget& target, const PathOutput& output, int value) {
+  uint8_t bytes[LAN_PACKET_SIZE];
+  lan_packet_encode(frame_for(output, value), target.key, bytes);
+  return sendto(target.fd, bytes, sizeof(bytes), 0, (struct sockaddr*)&target.addr, sizeof(target.addr)) ==
+         (ssize_t)sizeof(bytes);
+}
+
+static const PathOutput* find_output(const std::string& path) {
+  for (size_t i = 0; i < sizeof(PATH_OUTPUTS) / sizeof(PATH_OUTPUTS[0]); i++) {
+    if (path == PATH_OUTPUTS[i].path) return &PATH_OUTPUTS[i];
+  }
+  return NULL;
+}
+
+// Distinct, in-range values so each write can be told apart in the trace
+static int value_for(const PathOutput& output, unsigned index) {
+  if (output.binary) return (int)((index + 1) % 2);
+  return 20 + (int)((index * 37) % 141);
+}
+
+// Parses "<us> <kind> <index> <value>" trace lines for one output
+static void parse_trace_line(const char* line, const PathOutput& output, std::vector<Sample>& samples) {
+  unsigned long long time_us;
+  char kind[16];
+  unsigned index;
+  int value;
+  if (sscanf(line, "%llu %15s %u %d", &time_us, kind, &index, &value) != 4) return;
+  if (strcmp(kind, output.kind) != 0 || index != output.index) return;
+
+  // Servo lines carry the pulse width; compare in degrees like the writes
+  if (!output.binary) value = servo_pulse_us_to_angle((uint16_t)value);
+  Sample sample = { time_us, value };
+  samples.push_back(sample);
+}
+
+
+// ============================================================================
+//                              FIRMWARE PROCESS
+// ============================================================================
+static std::mutex trace_mutex;
+static std::vector<std::string> trace_lines;
+
+static pid_t spawn_firmware(const Options& options) {
+  int pipe_fds[2];
+  if (pipe(pipe_fds) != 0) {
+    perror("pipe");
+    exit(1);
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    std::string url = "http://" + options.host + ":" + std::to_string(options.port);
+    setenv("RTDB_URL", url.c_str(), 1);
+    setenv("HAL_TRACE", "1", 1);
+    setenv("HAL_CHIP_ID", options.device.c_str(), 1);
+    dup2(pipe_fds[1], STDOUT_FILENO);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    execl(options.firmware.c_str(), options.firmware.c_str(), (char*)NULL);
+    perror("exec");
+    _exit(127);
+  }
+  close(pipe_fds[1]);
+
+  std::thread([pipe_fds]() {
+    FILE* stream = fdopen(pipe_fds[0], "r");
+    char line[256];
+    while (fgets(line, sizeof(line), stream) != NULL) {
+      std::lock_guard<std::mutex> lock(trace_mutex);
+      trace_lines.push_back(line);
+    }
+  }).detach();
+  return pid;
+}
+
+
+// ============================================================================
+//                                    MAIN
+// ============================================================================
+static void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s (--firmware PATH | --trace FILE) [--host H] [--port N] [--path P]\n"
+          "          [--count N] [--burst N] [--interval-ms N] [--settle-ms N] [--frame | --lan]\n"
+          "          [--device ID]\n", program);
+  exit(2);
+}
+
+static unsigned long long percentile(const std::vector<unsigned long long>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t index = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--frame" || arg == "--lan") {
+      (arg == "--lan" ? options.lan : options.frame) = true;
+      continue;
+    }
+    if (i + 1 >= argc) usage(argv[0]);
+    if (arg == "--host") options.host = argv[++i];
+    else if (arg == "--port") options.port = (uint16_t)atoi(argv[++i]);
+    else if (arg == "--path") options.path = argv[++i];
+    else if (arg == "--count") options.count = (unsigned)atoi(argv[++i]);
+    else if (arg == "--burst") options.burst = (unsigned)atoi(argv[++i]);
+    else if (arg == "--interval-ms") options.interval_ms = (unsigned)atoi(argv[++i]);
+    else if (arg == "--settle-ms") options.settle_ms = (unsigned)atoi(argv[++i]);
+    else if (arg == "--firmware") options.firmware = argv[++i];
+    else if (arg == "--trace") options.trace_file = argv[++i];
+    else if (arg == "--device") options.device = argv[++i];
+    else usage(argv[0]);
+  }
+  if (options.firmware.empty() == options.trace_file.empty() || options.burst == 0) usage(argv[0]);
+  if (options.frame && options.lan) usage(argv[0]);
+
+  const PathOutput* output = find_output(options.path);
+  if (output == NULL) {
+    fprintf(stderr, "No known actuator output for %s\n", options.path.c_str());
+    return 2;
+  }
+  if ((options.frame || options.lan) && frame_path_for(*output) == NULL) {
+    fprintf(stderr, "Servo frames only carry gimbal axes\n");
+    return 2;
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  int fd = connect_to(options);
+
+  // Known starting value, delivered to the firmware in its initial snapshot
+  int initial = output->binary ? 0 : 90;
+  put_value(fd, options, options.path, initial);
+  if (options.frame) put_json(fd, options, frame_path_for(*output), "null");
+
+  pid_t firmware = -1;
+  if (!options.firmware.empty()) {
+    firmware = spawn_firmware(options);
+    std::this_thread::sleep_for(std::chrono::milliseconds(FIRMWARE_STARTUP_MS));
+  }
+
+  LanTarget lan;
+  if (options.lan && !open_lan(fd, options, lan)) {
+    fprintf(stderr, "No UDP LAN channel published at /lan\n");
+    return 1;
+  }
+
+  // Write bursts
+  std::vector<Sample> writes;
+  std::vector<unsigned long long> ack_us;
+  unsigned long long start_us = monotonic_us();
+  for (unsigned sent = 0; sent < options.count;) {
+    for (unsigned b = 0; b < options.burst && sent < options.count; b++, sent++) {
+      Sample write = { monotonic_us(), value_for(*output, sent) };
+      bool ok = options.lan ? send_lan_value(lan, *output, write.value)
+              : options.frame ? put_frame_value(fd, options, *output, write.value)
+              : put_value(fd, options, options.path, write.value);
+      if (!ok) {
+        fprintf(stderr, "Write %u failed\n", sent);
+        return 1;
+      }
+      ack_us.push_back(monotonic_us() - write.time_us);
+      writes.push_back(write);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.interval_ms));
+  }
+  unsigned long long send_duration_us = monotonic_us() - start_us;
+  std::this_thread::sleep_for(std::chrono::milliseconds(options.settle_ms));
+  close(fd);
+
+  // Collect the actuation trace
+  std::vector<Sample> actuations;
+  if (firmware > 0) {
+    kill(firmware, SIGTERM);
+    waitpid(firmware, NULL, 0);
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    for (size_t i = 0; i < trace_lines.size(); i++) parse_trace_line(trace_lines[i].c_str(), *output, actuations);
+  }
+  else {
+    FILE* trace = fopen(options.trace_file.c_str(), "r");
+    if (trace == NULL) {
+      perror(options.trace_file.c_str());
+      return 1;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), trace) != NULL) parse_trace_line(line, *output, actuations);
+    fclose(trace);
+  }
+
+  // Match each write to the first time its output reached the written value.
+  // Once the output shows a later write's value, the write was superseded.
+  std::vector<unsigned long long> latencies;
+  unsigned superseded = 0;
+  size_t cursor = 0;
+  for (size_t w = 0; w < writes.size(); w++) {
+    while (cursor < actuations.size() && actuations[cursor].time_us < writes[w].time_us) cursor++;
+
+    bool matched = false;
+    for (size_t a = cursor; a < actuations.size() && !matched; a++) {
+      if (actuations[a].value == writes[w].value) {
+        latencies.push_back(actuations[a].time_us - writes[w].time_us);
+        matched = true;
+        break;
+      }
+      bool moved_on = false;
+      for (size_t n = w + 1; n < writes.size() && writes[n].time_us <= actuations[a].time_us; n++) {
+        if (writes[n].value == actuations[a].value) moved_on = true;
+      }
+      if (moved_on) break;
+    }
+    if (!matched) superseded++;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  std::sort(ack_us.begin(), ack_us.end());
+
+  printf("path            %s%s\n", options.path.c_str(), options.lan ? " (LAN frames)" : options.frame ? " (RTDB frames)" : "");
+  printf("writes          %zu (%.1f/s)\n", writes.size(), writes.size() * 1e6 / (double)send_duration_us);
+  printf("actuated        %zu\n", latencies.size());
+  printf("superseded      %u\n", superseded);
+  printf("write ack  us   p50 %llu  p90 %llu  p99 %llu  max %llu\n",
+         percentile(ack_us, 0.50), percentile(ack_us, 0.90), percentile(ack_us, 0.99), percentile(ack_us, 1.0));
+  printf("actuation  us   p50 %llu  p90 %llu  p99 %llu  max %llu\n",
+         percentile(latencies, 0.50), percentile(latencies, 0.90), percentile(latencies, 0.99),
+         percentile(latencies, 1.0));
+  return 0;
+}
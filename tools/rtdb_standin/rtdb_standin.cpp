@@ -0,0 +1,432 @@
+/**
+ * Description:     Local stand-in for the Firebase RTDB, for lab benchmarking
+ *                  of the host build of the firmware.
+ *
+ *                  Speaks the subset of the RTDB REST protocol the firmware
+ *                  and tools use, over plain HTTP/1.1 on localhost:
+ *
+ *                    GET   /<path>.json                  subtree as JSON
+ *                    GET   /<path>.json?shallow=true     children, with
+ *                          objects reduced to true (ex: the device list
+ *                          under /devices)
+ *                    GET   /<path>.json  (Accept: text/event-stream)
+ *                          streaming listener: an initial "put" with the
+ *                          subtree, then "put"/"patch" events for every write
+ *                          under <path>, and "keep-alive" every 30 s
+ *                    PUT   /<path>.json  <json>          replace subtree
+ *                    PATCH /<path>.json  {"a/b": v, ...} multi-path update
+ *                    DELETE /<path>.json                 remove subtree
+ *
+ *                  The database is held as a flat map of leaf path to raw JSON
+ *                  scalar. Everything runs on one thread around poll(), so
+ *                  hundreds of streaming clients cost one file descriptor each.
+ *
+ *                  Usage: rtdb_standin [--port 9000] [--verbose]
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "host_json.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+const uint16_t DEFAULT_PORT = 9000;
+const int KEEP_ALIVE_INTERVAL_MS = 30000;
+const size_t MAX_REQUEST_BYTES = 1 << 20;
+
+static bool verbose = false;
+
+
+// ============================================================================
+//                                  DATABASE
+// ============================================================================
+// Leaf path (ex: "/laser_servo/x_angle") to raw JSON scalar
+static std::map<std::string, std::string> database;
+
+static bool path_is_under(const std::string& path, const std::string& parent) {
+  if (parent == "/") return true;
+  if (path.compare(0, parent.size(), parent) != 0) return false;
+  return path.size() == parent.size() || path[parent.size()] == '/';
+}
+
+static void delete_subtree(const std::string& path) {
+  std::map<std::string, std::string>::iterator it = database.lower_bound(path == "/" ? "" : path);
+  while (it != database.end() && path_is_under(it->first, path)) it = database.erase(it);
+}
+
+// Removes leaves that now sit above or below a newly written leaf, since a
+// node can't be both a scalar and an object
+static void set_leaf(const std::string& path, const std::string& value) {
+  delete_subtree(path);
+  for (size_t slash = path.rfind('/'); slash != std::string::npos && slash > 0; slash = path.rfind('/', slash - 1)) {
+    database.erase(path.substr(0, slash));
+  }
+  if (value != "null") database[path] = value;
+}
+
+static bool write_subtree(const std::string& path, const std::string& json) {
+  std::vector<std::pair<std::string, std::string> > leaves;
+  bool ok = json_flatten(json, path, [&leaves](const std::string& leaf, const std::string& value) {
+    leaves.push_back(std::make_pair(leaf, value));
+  });
+  if (!ok) return false;
+
+  delete_subtree(path);
+  for (size_t i = 0; i < leaves.size(); i++) set_leaf(leaves[i].first, leaves[i].second);
+  return true;
+}
+
+// Merges the leaves of an update object into the tree. Unlike the real RTDB,
+// siblings of a leaf inside a nested update value are kept, which doesn't
+// matter for the flat device paths written by the dashboard and tools.
+static bool patch_subtree(const std::string& path, const std::string& json) {
+  size_t first = json.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos || json[first] != '{') return false;
+
+  std::vector<std::pair<std::string, std::string> > leaves;
+  bool ok = json_flatten(json, path, [&leaves](const std::string& leaf, const std::string& value) {
+    leaves.push_back(std::make_pair(leaf, value));
+  });
+  if (!ok) return false;
+
+  for (size_t i = 0; i < leaves.size(); i++) set_leaf(leaves[i].first, leaves[i].second);
+  return true;
+}
+
+struct Node {
+  std::map<std::string, Node> children;
+  std::string value;
+};
+
+static void serialize(const Node& node, std::string& out) {
+  if (node.children.empty()) {
+    out += node.value.empty() ? "null" : node.value;
+    return;
+  }
+  out += '{';
+  bool first = true;
+  for (std::map<std::string, Node>::const_iterator it = node.children.begin(); it != node.children.end(); ++it) {
+    if (!first) out += ',';
+    first = false;
+    out += '"';
+    out += it->first;
+    out += "\":";
+    serialize(it->second, out);
+  }
+  out += '}';
+}
+
+static std::string read_subtree(const std::string& path) {
+  Node root;
+  std::string prefix = path == "/" ? "" : path;
+  std::map<std::string, std::string>::const_iterator it = database.lower_bound(prefix);
+  for (; it != database.end() && path_is_under(it->first, path); ++it) {
+    Node* node = &root;
+    std::string rest = it->first.substr(prefix.size());
+    size_t start = 1;
+    while (start <= rest.size() && !rest.empty()) {
+      size_t slash = rest.find('/', start);
+      if (slash == std::string::npos) slash = rest.size();
+      node = &node->children[rest.substr(start, slash - start)];
+      start = slash + 1;
+    }
+    node->value = it->second;
+  }
+  std::string out;
+  serialize(root, out);
+  return out;
+}
+
+// Children of path, objects replaced by true, as the RTDB's shallow query
+static std::string read_shallow(const std::string& path) {
+  std::string prefix = path == "/" ? "" : path;
+  std::map<std::string, std::string>::const_iterator it = database.lower_bound(prefix);
+  if (it != database.end() && it->first == path) return it->second;
+
+  // Leaves are sorted, so the leaves of one child are adjacent
+  std::string out;
+  std::string last_key;
+  for (; it != database.end() && path_is_under(it->first, path); ++it) {
+    std::string rest = it->first.substr(prefix.size() + 1);
+    size_t slash = rest.find('/');
+    std::string key = rest.substr(0, slash);
+    if (!out.empty() && key == last_key) continue;
+    last_key = key;
+
+    out += out.empty() ? "{\"" : ",\"";
+    out += key + "\":";
+    out += slash == std::string::npos ? it->second : "true";
+  }
+  return out.empty() ? "null" : out + "}";
+}
+
+
+// ============================================================================
+//                                   CLIENTS
+// ============================================================================
+struct Client {
+  int fd;
+  std::string in;
+  std::string out;
+  bool streaming;
+  std::string stream_path;
+  bool close_after_write;
+};
+
+static std::vector<Client> clients;
+
+static long long now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void send_response(Client& client, int status, const char* reason, const std::string& body) {
+  char header[256];
+  snprintf(header, sizeof(header),
+           "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\n\r\n",
+           status, reason, body.size());
+  client.out += header;
+  client.out += body;
+}
+
+static void send_event(Client& client, const char* event, const std::string& path, const std::string& data) {
+  client.out += "event: ";
+  client.out += event;
+  client.out += "\ndata: {\"path\":\"";
+  client.out += path;
+  client.out += "\",\"data\":";
+  client.out += data;
+  client.out += "}\n\n";
+}
+
+static std::string relative_path(const std::string& path, const std::string& parent) {
+  if (parent == "/") return path;
+  std::string rest = path.substr(parent.size());
+  return rest.empty() ? "/" : rest;
+}
+
+// Tells every listener covering path about a write there
+static void broadcast_write(const char* event, const std::string& path, const std::string& data) {
+  for (size_t i = 0; i < clients.size(); i++) {
+    Client& client = clients[i];
+    if (!client.streaming) continue;
+
+    if (path_is_under(path, client.stream_path)) {
+      send_event(client, event, relative_path(path, client.stream_path), data);
+    }
+    else if (path_is_under(client.stream_path, path)) {
+      // Write above the listener: resend its whole subtree
+      send_event(client, "put", "/", read_subtree(client.stream_path));
+    }
+  }
+}
+
+// Extracts the database path from "/a/b.json?query"
+static std::string request_path(const std::string& target) {
+  std::string path = target.substr(0, target.find('?'));
+  if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0) path.erase(path.size() - 5);
+  while (path.size() > 1 && path[path.size() - 1] == '/') path.erase(path.size() - 1);
+  if (path.empty()) path = "/";
+  return path;
+}
+
+static void handle_request(Client& client, const std::string& method, const std::string& target,
+                           const std::string& headers, const std::string& body) {
+  std::string path = request_path(target);
+  if (verbose) fprintf(stderr, "%s %s %s\n", method.c_str(), path.c_str(), body.c_str());
+
+  if (method == "GET") {
+    if (headers.find("text/event-stream") != std::string::npos) {
+      client.streaming = true;
+      client.stream_path = path;
+      client.out += "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n\r\n";
+      send_event(client, "put", "/", read_subtree(path));
+      return;
+    }
+    bool shallow = target.find("shallow=true") != std::string::npos;
+    send_response(client, 200, "OK", shallow ? read_shallow(path) : read_subtree(path));
+    return;
+  }
+
+  if (method == "PUT") {
+    if (!write_subtree(path, body)) {
+      send_response(client, 400, "Bad Request", "{\"error\":\"Invalid data; couldn't parse JSON object.\"}");
+      return;
+    }
+    send_response(client, 200, "OK", body);
+    broadcast_write("put", path, body);
+    return;
+  }
+
+  if (method == "PATCH") {
+    if (!patch_subtree(path, body)) {
+      send_response(client, 400, "Bad Request", "{\"error\":\"Invalid data; couldn't parse JSON object.\"}");
+      return;
+    }
+    send_response(client, 200, "OK", body);
+    broadcast_write("patch", path, body);
+    return;
+  }
+
+  if (method == "DELETE") {
+    delete_subtree(path);
+    send_response(client, 200, "OK", "null");
+    broadcast_write("put", path, "null");
+    return;
+  }
+
+  send_response(client, 405, "Method Not Allowed", "{\"error\":\"method not allowed\"}");
+}
+
+// Handles every complete request buffered for client
+static void process_input(Client& client) {
+  for (;;) {
+    size_t header_end = client.in.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+      if (client.in.size() > MAX_REQUEST_BYTES) client.close_after_write = true;
+      return;
+    }
+
+    std::string headers = client.in.substr(0, header_end);
+    size_t content_length = 0;
+    size_t cl = headers.find("Content-Length:");
+    if (cl == std::string::npos) cl = headers.find("content-length:");
+    if (cl != std::string::npos) content_length = strtoul(headers.c_str() + cl + 15, NULL, 10);
+
+    size_t total = header_end + 4 + content_length;
+    if (client.in.size() < total) return;
+
+    std::string body = client.in.substr(header_end + 4, content_length);
+    client.in.erase(0, total);
+
+    char method[16] = "";
+    char target[1024] = "";
+    sscanf(headers.c_str(), "%15s %1023s", method, target);
+    handle_request(client, method, target, headers, body);
+    if (client.streaming) return;
+  }
+}
+
+
+// ============================================================================
+//                                    MAIN
+// ============================================================================
+static int listen_on(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 1024) < 0) {
+    perror("listen");
+    exit(1);
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  return fd;
+}
+
+int main(int argc, char** argv) {
+  uint16_t port = DEFAULT_PORT;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = (uint16_t)atoi(argv[++i]);
+    else if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--port N] [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  int listen_fd = listen_on(port);
+  fprintf(stderr, "RTDB stand-in listening on http://127.0.0.1:%u\n", port);
+
+  long long next_keep_alive = now_ms() + KEEP_ALIVE_INTERVAL_MS;
+  std::vector<struct pollfd> fds;
+
+  for (;;) {
+    fds.clear();
+    struct pollfd listener = { listen_fd, POLLIN, 0 };
+    fds.push_back(listener);
+    for (size_t i = 0; i < clients.size(); i++) {
+      struct pollfd pfd = { clients[i].fd, (short)(POLLIN | (clients[i].out.empty() ? 0 : POLLOUT)), 0 };
+      fds.push_back(pfd);
+    }
+
+    int timeout = (int)(next_keep_alive - now_ms());
+    poll(&fds[0], fds.size(), timeout < 0 ? 0 : timeout);
+
+    if (now_ms() >= next_keep_alive) {
+      for (size_t i = 0; i < clients.size(); i++) {
+        if (clients[i].streaming) clients[i].out += "event: keep-alive\ndata: null\n\n";
+      }
+      next_keep_alive = now_ms() + KEEP_ALIVE_INTERVAL_MS;
+    }
+
+    // Reads first so writes produced by one client reach every listener
+    // in the same pass
+    std::vector<bool> closed(clients.size(), false);
+    for (size_t i = 1; i < fds.size(); i++) {
+      if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+      Client& client = clients[i - 1];
+      char buffer[16384];
+      ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+      if (n <= 0) {
+        closed[i - 1] = true;
+        continue;
+      }
+      if (client.streaming) continue;
+      client.in.append(buffer, (size_t)n);
+      process_input(client);
+    }
+
+    for (size_t i = 0; i < clients.size(); i++) {
+      Client& client = clients[i];
+      if (closed[i] || client.out.empty()) continue;
+      ssize_t n = send(client.fd, client.out.data(), client.out.size(), MSG_DONTWAIT);
+      if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) closed[i] = true;
+      else if (n > 0) client.out.erase(0, (size_t)n);
+      if (client.out.empty() && client.close_after_write) closed[i] = true;
+    }
+
+    for (size_t i = clients.size(); i-- > 0;) {
+      if (!closed[i]) continue;
+      close(clients[i].fd);
+      clients.erase(clients.begin() + (long)i);
+    }
+
+    if (fds[0].revents & POLLIN) {
+      for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) break;
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        Client client = { fd, "", "", false, "", false };
+        clients.push_back(client);
+      }
+    }
+  }
+}
@@ -0,0 +1,117 @@
+/**
+ * Description:     Stress test and throughput benchmark for the command ring
+ *                  (src/spsc_ring.h) on the host.
+ *
+ *                  A producer thread pushes sequence-numbered Commands into a
+ *                  CommandRing, the same type the network and actuator tasks
+ *                  share, while a consumer thread pops them. Every field of
+ *                  each popped command is derived from its sequence number,
+ *                  so a lost, repeated, reordered or torn command fails the
+ *                  run. Neither side sleeps: a full or empty ring is retried
+ *                  after a yield, which keeps the ring at its edges as much as
+ *                  possible. It prints commands/s and how often each side
+ *                  found the ring full or empty.
+ *
+ *                  Build with -fsanitize=thread to check the memory ordering
+ *                  as well.
+ *
+ *                  Usage:
+ *                    spsc_stress [--commands 50000000]
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/16/2026
+ */
+
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "actuator_task.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static CommandRing ring;
+
+// The command carrying sequence number `sequence`
+static Command command_for(uint64_t sequence) {
+  Command command;
+  command.device = (uint8_t)(sequence >> 32);
+  command.channel = (uint8_t)(sequence * 7);
+  command.value = (int32_t)(sequence ^ (sequence >> 16));
+  command.timestamp_us = (uint32_t)sequence;
+  return command;
+}
+
+static bool same_command(const Command& a, const Command& b) {
+  return a.device == b.device && a.channel == b.channel && a.value == b.value && a.timestamp_us == b.timestamp_us;
+}
+
+int main(int argc, char** argv) {
+  uint64_t commands = 50000000;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--commands") == 0) commands = strtoull(argv[i + 1], NULL, 10);
+  }
+  if (commands == 0) {
+    fprintf(stderr, "Usage: spsc_stress [--commands 50000000]\n");
+    return 1;
+  }
+
+  uint64_t full = 0;
+  uint64_t empty = 0;
+  uint64_t received = 0;
+  bool ordered = true;
+  Command expected;
+  Command actual;
+
+  Clock::time_point start = Clock::now();
+  std::thread producer([commands, &full]() {
+    for (uint64_t sequence = 0; sequence < commands; sequence++) {
+      Command command = command_for(sequence);
+      while (!ring.push(command)) {
+        full++;
+        std::this_thread::yield();
+      }
+    }
+  });
+  std::thread consumer([commands, &empty, &received, &ordered, &expected, &actual]() {
+    Command command;
+    while (received < commands) {
+      if (!ring.pop(command)) {
+        empty++;
+        std::this_thread::yield();
+        continue;
+      }
+      if (!same_command(command, command_for(received))) {
+        expected = command_for(received);
+        actual = command;
+        ordered = false;
+        return;
+      }
+      received++;
+    }
+  });
+  consumer.join();
+
+  // A consumer that stopped early leaves the producer blocked on a full ring
+  if (!ordered) {
+    fprintf(stderr, "FAIL: command %llu was {%u, %u, %d, %u}, expected {%u, %u, %d, %u}\n",
+            (unsigned long long)received, actual.device, actual.channel, actual.value, actual.timestamp_us,
+            expected.device, expected.channel, expected.value, expected.timestamp_us);
+    exit(1);
+  }
+  producer.join();
+  double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  if (!ring.empty()) {
+    fprintf(stderr, "FAIL: %u commands left in the ring\n", ring.size());
+    return 1;
+  }
+
+  printf("commands:       %12llu in order, none lost\n", (unsigned long long)received);
+  printf("throughput:     %12.0f commands/s\n", received / seconds);
+  printf("ring full:      %12llu producer retries\n", (unsigned long long)full);
+  printf("ring empty:     %12llu consumer retries\n", (unsigned long long)empty);
+  printf("ring capacity:  %12u commands\n", CommandRing::capacity());
+  return 0;
+}
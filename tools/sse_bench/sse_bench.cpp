@@ -0,0 +1,447 @@
+/**
+ * Description:     Fuzz and benchmark harness for the RTDB stream parser
+ *                  (src/hal/sse_parser.h).
+ *
+ *                  Benchmark: decodes a steady-state stream (value puts,
+ *                  multi-path patches, base64 frames, unwatched values and
+ *                  keep-alives) and an initial snapshot of the desired
+ *                  state. It reports ns/event and heap allocations/event for
+ *                  SseParser and for the String-based path it replaced.
+ *                  FirebaseESP32 does not run on the host, so that path is
+ *                  represented by the previous host decoder, which has the
+ *                  same shape: each event is copied out of a growing string,
+ *                  its lines are split into strings, the JSON is flattened
+ *                  into (path, text) string pairs and the values are picked
+ *                  out by path. Allocations are counted by replacing the
+ *                  global operator new.
+ *
+ *                  Fuzz: random event streams, plain or chunked, are fed
+ *                  in random splits. The leaves delivered must match a
+ *                  single-buffer parse, and for plain streams they must also
+ *                  match the old decoder. Mutated streams (flipped, dropped
+ *                  and inserted bytes) must never deliver an unwatched path.
+ *                  Build with -fsanitize=address,undefined to catch memory
+ *                  errors as well.
+ *
+ *                  Usage:
+ *                    sse_bench [--events 200000] [--fuzz 20000] [--seed 1]
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/15/2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "device_shadow.h"
+#include "device_table.h"
+#include "servo_frame.h"
+#include "hal/host_json.h"
+#include "hal/sse_parser.h"
+
+typedef std::chrono::steady_clock Clock;
+
+
+// ============================================================================
+//                             ALLOCATION COUNTING
+// ============================================================================
+static unsigned long long allocations = 0;
+
+void* operator new(size_t size) {
+  allocations++;
+  void* memory = malloc(size != 0 ? size : 1);
+  if (memory == NULL) throw std::bad_alloc();
+  return memory;
+}
+
+void operator delete(void* memory) noexcept {
+  free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+  free(memory);
+}
+
+
+// ============================================================================
+//                                   CORPUS
+// ============================================================================
+static const char* watched_paths[DEVICE_CHANNEL_COUNT + 1 + SERVO_FRAME_PATH_COUNT + POSE_LEAF_COUNT];
+static const uint8_t WATCHED_COUNT = sizeof(watched_paths) / sizeof(watched_paths[0]);
+
+static const char* HTTP_HEAD = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n\r\n";
+static const char* HTTP_HEAD_CHUNKED =
+  "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nTransfer-Encoding: chunked\r\n\r\n";
+
+static std::string event(const char* type, const std::string& path, const std::string& data) {
+  return std::string("event: ") + type + "\ndata: {\"path\":\"" + path + "\",\"data\":" + data + "}\n\n";
+}
+
+// The device streams its desired state only; its uplinks are siblings
+static std::string root_snapshot(void) {
+  std::string data = "{\"camera_servo\":{\"x_angle\":90,\"y_angle\":90,\"frame\":\"AgIBAAAAIAUgBQ==\"},"
+                     "\"heating_pad\":{\"setpoint\":300,\"state\":1},"
+                     "\"laser_servo\":{\"x_angle\":120,\"y_angle\":45,"
+                     "\"pose\":{\"seq\":7,\"x\":120,\"y\":45}},"
+                     "\"temperature_sensor\":{\"state\":1},\"version\":42,"
+                     "\"note\":{\"text\":\"set from the dashboard\",\"tags\":[\"a\",\"b\"]}}";
+  return event("put", "/", data);
+}
+
+// Events seen once the stream is up, in rough proportion
+static std::vector<std::string> steady_events(void) {
+  std::vector<std::string> events;
+  for (int angle = 20; angle < 160; angle += 10) {
+    events.push_back(event("put", "/laser_servo/x_angle", std::to_string(angle)));
+    events.push_back(event("patch", "/", "{\"laser_servo/x_angle\":" + std::to_string(angle) +
+                                         ",\"laser_servo/y_angle\":" + std::to_string(180 - angle) +
+                                         ",\"version\":" + std::to_string(angle) + "}"));
+
+    ServoFrame frame = { DEVICE_LASER, (uint32_t)angle, servo_angle_to_pulse_us(angle),
+                         servo_angle_to_pulse_us(180 - angle) };
+    char text[SERVO_FRAME_TEXT_SIZE];
+    servo_frame_encode_text(frame, text);
+    events.push_back(event("put", "/laser_servo/frame", std::string("\"") + text + "\""));
+    events.push_back(event("put", "/camera_servo/pose", "{\"seq\":" + std::to_string(angle) + ",\"x\":" +
+                                                          std::to_string(angle) + ",\"y\":90}"));
+  }
+  events.push_back(event("put", "/heating_pad/state", "true"));
+  events.push_back(event("put", "/heating_pad/setpoint", "295.6"));
+  events.push_back(event("put", "/version", "43"));
+  events.push_back(event("put", "/note/text", "\"esc\\\"aped \\u00e9\""));
+  events.push_back(event("put", "/camera_servo/x_angle", "null"));
+  events.push_back("event: keep-alive\ndata: null\n\n");
+  events.push_back(": comment\n\n");
+  return events;
+}
+
+// Wraps body in chunks of random sizes
+static std::string chunked(const std::string& body, std::mt19937& random) {
+  std::string out;
+  size_t offset = 0;
+  while (offset < body.size()) {
+    size_t size = std::min(body.size() - offset, (size_t)(1 + random() % 200));
+    char header[32];
+    snprintf(header, sizeof(header), random() % 2 ? "%zx\r\n" : "%zX;ext=1\r\n", size);
+    out += header;
+    out.append(body, offset, size);
+    out += "\r\n";
+    offset += size;
+  }
+  return out;
+}
+
+
+// ============================================================================
+//                                   SINKS
+// ============================================================================
+// Benchmark sinks only fold the values in, so they allocate nothing
+static unsigned long long sink_checksum = 0;
+static unsigned long long sink_count = 0;
+
+static void checksum_value(const char* path, int value) {
+  sink_checksum = sink_checksum * 31 + (unsigned)value + (unsigned char)path[1];
+  sink_count++;
+}
+
+static void checksum_text(const char* path, const char* text) {
+  sink_checksum = sink_checksum * 31 + (unsigned char)text[0] + (unsigned char)path[1];
+  sink_count++;
+}
+
+// Fuzz sinks record each leaf
+static std::vector<std::string>* recorded = NULL;
+
+static void record_value(const char* path, int value) {
+  recorded->push_back(std::string(path) + "=" + std::to_string(value));
+}
+
+static void record_text(const char* path, const char* text) {
+  recorded->push_back(std::string(path) + "=\"" + text + "\"");
+}
+
+
+// ============================================================================
+//                                  DECODERS
+// ============================================================================
+// Feeds input in pieces of at most max_split bytes (random sizes if random is
+// given). Appends the status of every finished event to statuses, if given.
+static void feed_parser(SseParser& parser, const std::string& input, size_t max_split, std::mt19937* random,
+                        HalStreamValueSink sink, HalStreamTextSink text_sink, std::vector<int>* statuses) {
+  size_t offset = 0;
+  for (;;) {
+    SseStatus status = parser.parse(sink, text_sink);
+    if (status != SSE_MORE) {
+      if (statuses != NULL) statuses->push_back(status);
+      if (status == SSE_CLOSED || status == SSE_REDIRECT || status == SSE_HTTP_ERROR) break;
+      continue;
+    }
+    if (offset == input.size()) break;
+
+    size_t space;
+    char* at = parser.receive_space(space);
+    size_t piece = random != NULL ? 1 + (*random)() % max_split : max_split;
+    piece = std::min(std::min(piece, space), input.size() - offset);
+    memcpy(at, input.data() + offset, piece);
+    parser.received(piece);
+    offset += piece;
+  }
+}
+
+// The String-based decoder SseParser replaced: one growing buffer, the
+// event and its lines copied out, the JSON flattened into string pairs
+class StringDecoder {
+public:
+  void begin(void) {
+    buffer.clear();
+    headers_done = false;
+  }
+
+  // Appends bytes and decodes every complete event. Returns the event count.
+  unsigned feed(const char* data, size_t length, HalStreamValueSink sink, HalStreamTextSink text_sink) {
+    buffer.append(data, length);
+    if (!headers_done) {
+      size_t end = buffer.find("\r\n\r\n");
+      if (end == std::string::npos) return 0;
+      buffer.erase(0, end + 4);
+      headers_done = true;
+    }
+
+    unsigned events = 0;
+    for (;;) {
+      size_t end = buffer.find("\n\n");
+      if (end == std::string::npos) return events;
+      std::string event = buffer.substr(0, end);
+      buffer.erase(0, end + 2);
+
+      std::string type;
+      std::string payload;
+      size_t line_start = 0;
+      while (line_start < event.size()) {
+        size_t line_end = event.find('\n', line_start);
+        if (line_end == std::string::npos) line_end = event.size();
+        std::string line = event.substr(line_start, line_end - line_start);
+        if (line.compare(0, 7, "event: ") == 0) type = line.substr(7);
+        else if (line.compare(0, 6, "data: ") == 0) payload = line.substr(6);
+        line_start = line_end + 1;
+      }
+      if (type == "put" || type == "patch") {
+        deliver(payload, sink, text_sink);
+        events++;
+      }
+    }
+  }
+
+private:
+  std::string buffer;
+  bool headers_done = false;
+
+  static bool watched(const std::string& path) {
+    for (uint8_t i = 0; i < WATCHED_COUNT; i++) {
+      if (path == watched_paths[i]) return true;
+    }
+    return false;
+  }
+
+  static void deliver(const std::string& payload, HalStreamValueSink sink, HalStreamTextSink text_sink) {
+    std::string event_path = "/";
+    std::vector<std::pair<std::string, std::string> > leaves;
+    json_flatten(payload, "/", [&](const std::string& leaf, const std::string& value) {
+      if (leaf == "/path" && value.size() >= 2) event_path = value.substr(1, value.size() - 2);
+      else if (leaf.compare(0, 5, "/data") == 0) leaves.push_back(std::make_pair(leaf.substr(5), value));
+    });
+
+    for (size_t i = 0; i < leaves.size(); i++) {
+      std::string path = json_join_path(event_path, leaves[i].first);
+      if (!watched(path)) continue;
+      int value;
+      std::string text;
+      if (json_scalar_to_int(leaves[i].second, value)) sink(path.c_str(), value);
+      else if (json_scalar_to_string(leaves[i].second, text)) text_sink(path.c_str(), text.c_str());
+    }
+  }
+};
+
+
+// ============================================================================
+//                                 BENCHMARK
+// ============================================================================
+struct BenchResult {
+  double ns_per_event;
+  double allocations_per_event;
+  unsigned long long checksum;
+};
+
+// Decodes stream (events of it, after the head) `rounds` times, as 512 byte
+// reads like the socket delivers
+static BenchResult bench_parser(const std::string& stream, unsigned events, unsigned rounds) {
+  SseParser parser;
+  sink_checksum = 0;
+  unsigned long long start_allocations = allocations;
+  Clock::time_point start = Clock::now();
+  for (unsigned round = 0; round < rounds; round++) {
+    parser.begin("/", watched_paths, WATCHED_COUNT);
+    feed_parser(parser, stream, SSE_RECEIVE_BUFFER_SIZE, NULL, checksum_value, checksum_text, NULL);
+  }
+  double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  BenchResult result = { elapsed / ((double)events * rounds),
+                         (double)(allocations - start_allocations) / ((double)events * rounds), sink_checksum };
+  return result;
+}
+
+static BenchResult bench_strings(const std::string& stream, unsigned events, unsigned rounds) {
+  StringDecoder decoder;
+  sink_checksum = 0;
+  unsigned long long start_allocations = allocations;
+  Clock::time_point start = Clock::now();
+  for (unsigned round = 0; round < rounds; round++) {
+    decoder.begin();
+    for (size_t offset = 0; offset < stream.size(); offset += SSE_RECEIVE_BUFFER_SIZE) {
+      decoder.feed(stream.data() + offset, std::min(SSE_RECEIVE_BUFFER_SIZE, stream.size() - offset),
+                   checksum_value, checksum_text);
+    }
+  }
+  double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  BenchResult result = { elapsed / ((double)events * rounds),
+                         (double)(allocations - start_allocations) / ((double)events * rounds), sink_checksum };
+  return result;
+}
+
+static void print_comparison(const char* name, const BenchResult& parser, const BenchResult& strings) {
+  printf("%s\n", name);
+  printf("  SseParser      %9.0f ns/event  %7.2f allocations/event\n", parser.ns_per_event,
+         parser.allocations_per_event);
+  printf("  String decoder %9.0f ns/event  %7.2f allocations/event\n", strings.ns_per_event,
+         strings.allocations_per_event);
+  if (parser.checksum != strings.checksum) printf("  WARNING: decoders delivered different values\n");
+}
+
+
+// ============================================================================
+//                                    FUZZ
+// ============================================================================
+static bool is_watched(const std::string& leaf) {
+  std::string path = leaf.substr(0, leaf.find('='));
+  for (uint8_t i = 0; i < WATCHED_COUNT; i++) {
+    if (path == watched_paths[i]) return true;
+  }
+  return false;
+}
+
+static std::vector<std::string> parse_leaves(const std::string& input, size_t max_split, std::mt19937* random,
+                                             std::vector<int>* statuses) {
+  std::vector<std::string> leaves;
+  recorded = &leaves;
+  SseParser parser;
+  parser.begin("/", watched_paths, WATCHED_COUNT);
+  feed_parser(parser, input, max_split, random, record_value, record_text, statuses);
+  return leaves;
+}
+
+static std::vector<std::string> old_decoder_leaves(const std::string& input) {
+  std::vector<std::string> leaves;
+  recorded = &leaves;
+  StringDecoder decoder;
+  decoder.begin();
+  decoder.feed(input.data(), input.size(), record_value, record_text);
+  return leaves;
+}
+
+static void mutate(std::string& input, std::mt19937& random) {
+  unsigned edits = 1 + random() % 8;
+  for (unsigned i = 0; i < edits && !input.empty(); i++) {
+    size_t at = random() % input.size();
+    switch (random() % 3) {
+      case 0: input[at] = (char)(random() % 256); break;
+      case 1: input.erase(at, 1); break;
+      default: input.insert(at, 1, "{}[]\",:\\\n/ 0a"[random() % 14]); break;
+    }
+  }
+}
+
+static unsigned fuzz(unsigned cases, std::mt19937& random, const std::vector<std::string>& events) {
+  unsigned failures = 0;
+  for (unsigned n = 0; n < cases; n++) {
+    std::string body;
+    unsigned count = 1 + random() % 8;
+    for (unsigned i = 0; i < count; i++) body += events[random() % events.size()];
+    bool use_chunks = random() % 2 == 0;
+    std::string input = use_chunks ? std::string(HTTP_HEAD_CHUNKED) + chunked(body, random) + "0\r\n\r\n"
+                                   : std::string(HTTP_HEAD) + body;
+
+    std::vector<int> whole_statuses;
+    std::vector<int> split_statuses;
+    std::vector<std::string> whole = parse_leaves(input, SSE_RECEIVE_BUFFER_SIZE, NULL, &whole_statuses);
+    std::vector<std::string> split = parse_leaves(input, 1 + random() % 64, &random, &split_statuses);
+    if (whole != split || whole_statuses != split_statuses) {
+      if (failures++ < 5) fprintf(stderr, "Split parse differs on case %u\n", n);
+    }
+    if (!use_chunks && whole != old_decoder_leaves(input)) {
+      if (failures++ < 5) fprintf(stderr, "Old decoder differs on case %u\n", n);
+    }
+
+    mutate(input, random);
+    std::vector<std::string> mutated = parse_leaves(input, 1 + random() % 64, &random, NULL);
+    for (size_t i = 0; i < mutated.size(); i++) {
+      if (!is_watched(mutated[i])) {
+        if (failures++ < 5) fprintf(stderr, "Unwatched leaf %s on mutated case %u\n", mutated[i].c_str(), n);
+        break;
+      }
+    }
+  }
+  return failures;
+}
+
+
+// ============================================================================
+//                                    MAIN
+// ============================================================================
+int main(int argc, char** argv) {
+  unsigned events_target = 200000;
+  unsigned fuzz_cases = 20000;
+  unsigned seed = 1;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--events") == 0) events_target = (unsigned)atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--fuzz") == 0) fuzz_cases = (unsigned)atoi(argv[i + 1]);
+    else if (strcmp(argv[i], "--seed") == 0) seed = (unsigned)atoi(argv[i + 1]);
+    else {
+      fprintf(stderr, "usage: %s [--events N] [--fuzz N] [--seed N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  for (uint8_t row = 0; row < DEVICE_CHANNEL_COUNT; row++) watched_paths[row] = DeviceIndex::paths[row];
+  watched_paths[DEVICE_CHANNEL_COUNT] = SHADOW_VERSION_PATH;
+  for (uint8_t i = 0; i < SERVO_FRAME_PATH_COUNT; i++) watched_paths[DEVICE_CHANNEL_COUNT + 1 + i] = SERVO_FRAME_PATHS[i].path;
+  const char** pose_leaves = watched_paths + DEVICE_CHANNEL_COUNT + 1 + SERVO_FRAME_PATH_COUNT;
+  for (uint8_t i = 0; i < POSE_PATH_COUNT; i++) {
+    pose_leaves[3 * i] = POSE_PATHS[i].x;
+    pose_leaves[3 * i + 1] = POSE_PATHS[i].y;
+    pose_leaves[3 * i + 2] = POSE_PATHS[i].seq;
+  }
+
+  std::vector<std::string> events = steady_events();
+  std::string steady = HTTP_HEAD;
+  for (size_t i = 0; i < events.size(); i++) steady += events[i];
+  unsigned rounds = std::max(1u, events_target / (unsigned)events.size());
+  print_comparison("Steady-state events", bench_parser(steady, (unsigned)events.size(), rounds),
+                   bench_strings(steady, (unsigned)events.size(), rounds));
+
+  std::string snapshot = std::string(HTTP_HEAD) + root_snapshot();
+  printf("  (%zu events, %zu bytes per round)\n", events.size(), steady.size());
+  print_comparison("Initial snapshot", bench_parser(snapshot, 1, std::max(1u, rounds / 20)),
+                   bench_strings(snapshot, 1, std::max(1u, rounds / 20)));
+  printf("  (%zu bytes)\n", snapshot.size());
+
+  events.push_back(root_snapshot());
+  std::mt19937 random(seed);
+  unsigned failures = fuzz(fuzz_cases, random, events);
+  printf("Fuzz: %u cases, %u failures\n", fuzz_cases, failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,519 @@
+/**
+ * Description:     Replays a device stream recording through the host build
+ *                  and reports what the outputs did.
+ *
+ *                  The recording is a console capture of a firmware built
+ *                  with -DSTREAM_RECORDER (src/stream_recorder.h), from the
+ *                  ESP32 or the host. The firmware under test is run with
+ *                  HAL_REPLAY set to it, fresh storage and HAL_TRACE=1, and
+ *                  its trace gives both when each recorded event was
+ *                  delivered and every output edge that followed. By default
+ *                  it runs in virtual time (HAL_CLOCK=virtual) as fast as
+ *                  the CPU allows, and two runs of one build give the same
+ *                  trace; --realtime replays at 1x on the real clock
+ *                  instead.
+ *
+ *                  Each recorded value that maps to an output is a target:
+ *                  a device value, a pose axis, or either axis of a servo
+ *                  frame, clamped to the output's limits. A target's latency
+ *                  runs from its event's delivery to the first time the
+ *                  output takes the value. Servo latency includes the motion
+ *                  planner's travel time and the wait for the next 20 ms PWM
+ *                  period, as with tools/rtdb_loadgen. A target the output
+ *                  already held is unchanged, one replaced by a later event
+ *                  before it was reached is superseded, and one still not
+ *                  reached when the firmware exited is unreached.
+ *
+ *                  --timeline prints the events and output edges in order.
+ *                  --save writes every target's outcome to a file, and
+ *                  --baseline compares against one saved earlier (ex: from
+ *                  the previous build): targets whose latency moved by more
+ *                  than --tolerance-us are listed, and the exit status is 1
+ *                  if there are any.
+ *
+ *                  Usage:
+ *                    stream_replay --firmware .pio/build/native/program
+ *                                  --recording capture.log [--realtime]
+ *                                  [--timeline] [--save results.txt]
+ *                                  [--baseline results.txt]
+ *                                  [--tolerance-us 0] [--verbose]
+ *
+ * Author:          Eddie Kwak
+ * Last Modified:   10/16/2026
+ */
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "command.h"
+#include "device_table.h"
+#include "servo_frame.h"
+#include "stream_dispatch.h"
+
+// ============================================================================
+//                               CONFIGURATION
+// ============================================================================
+struct Options {
+  std::string firmware;
+  std::string recording;
+  bool realtime = false;
+  bool timeline = false;
+  bool verbose = false;
+  std::string save_file;
+  std::string baseline_file;
+  unsigned long long tolerance_us = 0;
+};
+
+// Every trace line keeps its position in the trace, since in virtual time an
+// event and the edges it causes share a timestamp
+struct Actuation {
+  size_t line;
+  unsigned long long time_us;
+  std::string output;   // ex: "servo 2"
+  int value;            // level, or degrees for servos
+  int raw;              // level, or pulse width for servos
+};
+
+struct Event {
+  size_t line;
+  unsigned index;
+  unsigned long long time_us;
+  std::string pairs;
+};
+
+enum Outcome { OUTCOME_ACTUATED, OUTCOME_UNCHANGED, OUTCOME_SUPERSEDED, OUTCOME_UNREACHED, OUTCOME_COUNT };
+
+struct Target {
+  unsigned event;
+  size_t line;          // the event's trace line
+  unsigned long long time_us;
+  std::string output;
+  int value;
+  Outcome outcome;
+  unsigned long long latency_us;
+};
+
+
+// ============================================================================
+//                                  HELPERS
+// ============================================================================
+// Device table row whose output a recorded path drives: the row at that
+// path, or the axis a pose leaf sets. DEVICE_NO_ROW for anything else,
+// setpoints included, since they only drive the heater through the
+// thermostat.
+static uint8_t output_row(const char* path) {
+  uint8_t row = device_row_for_path(path);
+  for (uint8_t i = 0; i < POSE_PATH_COUNT && row == DEVICE_NO_ROW; i++) {
+    if (strcmp(path, POSE_PATHS[i].x) == 0) row = device_row_for_command(POSE_PATHS[i].device, CHANNEL_X);
+    else if (strcmp(path, POSE_PATHS[i].y) == 0) row = device_row_for_command(POSE_PATHS[i].device, CHANNEL_Y);
+  }
+  if (row == DEVICE_NO_ROW || DEVICE_TABLE[row].kind == DEVICE_KIND_SETPOINT) return DEVICE_NO_ROW;
+  return row;
+}
+
+// The row's output as the host HAL traces it: servos by channel, which is
+// their ServoAxis (see actuators.cpp), everything else by pin
+static std::string output_name(uint8_t row) {
+  const DeviceChannel& entry = DEVICE_TABLE[row];
+  if (entry.kind == DEVICE_KIND_SERVO) return "servo " + std::to_string(entry.axis);
+  return "gpio " + std::to_string(entry.pin);
+}
+
+// Clamps value the way the firmware does for the row
+static void add_target(std::vector<Target>& targets, const Event& event, uint8_t row, int value) {
+  const DeviceChannel& entry = DEVICE_TABLE[row];
+  if (entry.kind != DEVICE_KIND_SERVO) value = value != 0 ? 1 : 0;
+  else value = std::max((int)entry.min_value, std::min((int)entry.max_value, value));
+  Target target = { event.index, event.line, event.time_us, output_name(row), value, OUTCOME_UNREACHED, 0 };
+  targets.push_back(target);
+}
+
+// True if the event's "<path> <value> ..." pairs include path
+static bool has_path(const std::string& pairs, const char* path) {
+  return (" " + pairs + " ").find(std::string(" ") + path + " ") != std::string::npos;
+}
+
+// Gimbals whose whole pose node is in the event's pairs, as a bit per
+// POSE_PATHS entry. Their angle paths give way to the pose in the firmware.
+static unsigned complete_poses(const std::string& pairs) {
+  unsigned complete = 0;
+  for (uint8_t i = 0; i < POSE_PATH_COUNT; i++) {
+    if (has_path(pairs, POSE_PATHS[i].x) && has_path(pairs, POSE_PATHS[i].y) && has_path(pairs, POSE_PATHS[i].seq)) {
+      complete |= 1u << i;
+    }
+  }
+  return complete;
+}
+
+// True if path is the angle path of a gimbal whose pose is in complete
+static bool overridden_by_pose(uint8_t row, const char* path, unsigned complete) {
+  for (uint8_t i = 0; i < POSE_PATH_COUNT; i++) {
+    if (!(complete & (1u << i)) || DEVICE_TABLE[row].device != POSE_PATHS[i].device) continue;
+    if (strcmp(path, DEVICE_TABLE[row].path) == 0) return true;
+  }
+  return false;
+}
+
+// Targets of one replayed event, from its "<path> <value> ..." pairs
+static void event_targets(const Event& event, std::vector<Target>& targets) {
+  unsigned complete = complete_poses(event.pairs);
+  char pairs[512];
+  snprintf(pairs, sizeof(pairs), "%s", event.pairs.c_str());
+  char* save = NULL;
+  for (char* path = strtok_r(pairs, " ", &save); path != NULL; path = strtok_r(NULL, " ", &save)) {
+    char* value = strtok_r(NULL, " ", &save);
+    if (value == NULL) break;
+
+    uint8_t row = output_row(path);
+    if (row != DEVICE_NO_ROW && overridden_by_pose(row, path, complete)) continue;
+    if (row != DEVICE_NO_ROW && value[0] != '"') {
+      add_target(targets, event, row, atoi(value));
+      continue;
+    }
+
+    // Servo frames carry both axes as pulse widths
+    for (uint8_t i = 0; i < SERVO_FRAME_PATH_COUNT; i++) {
+      if (strcmp(path, SERVO_FRAME_PATHS[i].path) != 0) continue;
+      size_t length = strlen(value);
+      if (length < 2 || value[0] != '"') break;
+      value[length - 1] = '\0';
+
+      // The firmware drops a frame for any device but the path's gimbal
+      ServoFrame frame;
+      if (!servo_frame_decode_text(value + 1, frame) || frame.device != SERVO_FRAME_PATHS[i].device) break;
+      uint8_t x_row = device_row_for_command(frame.device, CHANNEL_X);
+      uint8_t y_row = device_row_for_command(frame.device, CHANNEL_Y);
+      if (x_row == DEVICE_NO_ROW || y_row == DEVICE_NO_ROW) break;
+      add_target(targets, event, x_row, servo_pulse_us_to_angle(frame.x_us));
+      add_target(targets, event, y_row, servo_pulse_us_to_angle(frame.y_us));
+    }
+  }
+}
+
+// Parses "<us> event <index> <pairs>" and "<us> <kind> <index> <value>"
+static void parse_trace_line(size_t number, const char* line, std::vector<Event>& events,
+                             std::vector<Actuation>& actuations) {
+  unsigned long long time_us;
+  char kind[16];
+  unsigned index;
+  int consumed = 0;
+  if (sscanf(line, "%llu %15s %u %n", &time_us, kind, &index, &consumed) != 3 || consumed == 0) return;
+
+  if (strcmp(kind, "event") == 0) {
+    std::string pairs = line + consumed;
+    while (!pairs.empty() && (pairs[pairs.size() - 1] == '\n' || pairs[pairs.size() - 1] == '\r')) {
+      pairs.erase(pairs.size() - 1);
+    }
+    Event event = { number, index, time_us, pairs };
+    events.push_back(event);
+    return;
+  }
+
+  int value;
+  if (sscanf(line + consumed, "%d", &value) != 1) return;
+  Actuation actuation = { number, time_us, std::string(kind) + " " + std::to_string(index), value, value };
+  if (strcmp(kind, "servo") == 0) actuation.value = servo_pulse_us_to_angle((uint16_t)value);
+  actuations.push_back(actuation);
+}
+
+static unsigned long long percentile(const std::vector<unsigned long long>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t index = (size_t)(p * (double)(sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+static const char* outcome_name(Outcome outcome) {
+  static const char* const NAMES[OUTCOME_COUNT] = { "actuated", "unchanged", "superseded", "unreached" };
+  return NAMES[outcome];
+}
+
+
+// ============================================================================
+//                                  REPLAY
+// ============================================================================
+// Runs the firmware on the recording and returns its trace
+static std::string run_replay(const Options& options) {
+  int pipe_fds[2];
+  if (pipe(pipe_fds) != 0) {
+    perror("pipe");
+    exit(1);
+  }
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    setenv("HAL_REPLAY", options.recording.c_str(), 1);
+    setenv("HAL_TRACE", "1", 1);
+    if (options.realtime) unsetenv("HAL_CLOCK");
+    else setenv("HAL_CLOCK", "virtual", 1);
+    unsetenv("RTDB_URL");
+    unsetenv("HAL_STORAGE_DIR");
+    dup2(pipe_fds[1], STDOUT_FILENO);
+    if (!options.verbose) {
+      int null_fd = open("/dev/null", O_WRONLY);
+      dup2(null_fd, STDERR_FILENO);
+    }
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    execl(options.firmware.c_str(), options.firmware.c_str(), (char*)NULL);
+    perror("exec");
+    _exit(127);
+  }
+  close(pipe_fds[1]);
+
+  std::string trace;
+  char buffer[4096];
+  for (ssize_t n; (n = read(pipe_fds[0], buffer, sizeof(buffer))) > 0;) trace.append(buffer, (size_t)n);
+  close(pipe_fds[0]);
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    fprintf(stderr, "Firmware exited abnormally (status %d)\n", status);
+    exit(1);
+  }
+  return trace;
+}
+
+// Settles every target against the output edges. Targets and actuations are
+// both in trace order, which is the order things happened in even where
+// timestamps tie: an edge traced before an event's line was there before it,
+// and one traced after was caused by it or by a later event.
+static void match_targets(std::vector<Target>& targets, const std::vector<Actuation>& actuations) {
+  for (size_t t = 0; t < targets.size(); t++) {
+    Target& target = targets[t];
+
+    // Value held when the event arrived
+    int held = -1;
+    size_t a = 0;
+    for (; a < actuations.size() && actuations[a].line < target.line; a++) {
+      if (actuations[a].output == target.output) held = actuations[a].value;
+    }
+    if (held == target.value) {
+      target.outcome = OUTCOME_UNCHANGED;
+      continue;
+    }
+
+    // The next target for the same output, if any, ends the wait. Without
+    // one, a target never reached was cut off by the exit, not superseded.
+    size_t deadline_line = ~(size_t)0;
+    for (size_t n = t + 1; n < targets.size(); n++) {
+      if (targets[n].output == target.output && targets[n].event != target.event) {
+        deadline_line = targets[n].line;
+        target.outcome = OUTCOME_SUPERSEDED;
+        break;
+      }
+    }
+
+    for (; a < actuations.size() && actuations[a].line < deadline_line; a++) {
+      if (actuations[a].output != target.output || actuations[a].value != target.value) continue;
+      target.outcome = OUTCOME_ACTUATED;
+      target.latency_us = actuations[a].time_us - target.time_us;
+      break;
+    }
+  }
+}
+
+
+// ============================================================================
+//                                  REPORTS
+// ============================================================================
+static void print_timeline(const std::vector<Event>& events, const std::vector<Actuation>& actuations,
+                           unsigned long long origin_us) {
+  size_t e = 0;
+  size_t a = 0;
+  while (e < events.size() || a < actuations.size()) {
+    bool event_next = a == actuations.size() || (e < events.size() && events[e].time_us <= actuations[a].time_us);
+    if (event_next) {
+      printf("%12.3f ms  event %u  %s\n", (events[e].time_us - origin_us) / 1000.0, events[e].index,
+             events[e].pairs.c_str());
+      e++;
+      continue;
+    }
+    const Actuation& actuation = actuations[a++];
+    if (actuation.time_us < origin_us) continue;
+    if (actuation.output.compare(0, 5, "servo") == 0) {
+      printf("%12.3f ms    %s  %d us (%d deg)\n", (actuation.time_us - origin_us) / 1000.0,
+             actuation.output.c_str(), actuation.raw, actuation.value);
+    }
+    else {
+      printf("%12.3f ms    %s  %d\n", (actuation.time_us - origin_us) / 1000.0, actuation.output.c_str(),
+             actuation.value);
+    }
+  }
+  printf("\n");
+}
+
+static void print_latencies(const char* label, std::vector<unsigned long long> latencies) {
+  std::sort(latencies.begin(), latencies.end());
+  printf("%-10s us   n %zu  p50 %llu  p90 %llu  p99 %llu  max %llu\n", label, latencies.size(),
+         percentile(latencies, 0.50), percentile(latencies, 0.90), percentile(latencies, 0.99),
+         percentile(latencies, 1.0));
+}
+
+static void print_summary(const std::vector<Event>& events, const std::vector<Target>& targets,
+                          const Options& options) {
+  unsigned counts[OUTCOME_COUNT] = { 0, 0, 0, 0 };
+  std::vector<unsigned long long> all;
+  std::map<std::string, std::vector<unsigned long long> > by_output;
+  for (size_t t = 0; t < targets.size(); t++) {
+    counts[targets[t].outcome]++;
+    if (targets[t].outcome != OUTCOME_ACTUATED) continue;
+    all.push_back(targets[t].latency_us);
+    by_output[targets[t].output].push_back(targets[t].latency_us);
+  }
+
+  unsigned long long span_us = events.size() < 2 ? 0 : events.back().time_us - events.front().time_us;
+  printf("recording       %s (%s)\n", options.recording.c_str(), options.realtime ? "real time" : "virtual time");
+  printf("events          %zu over %.3f s\n", events.size(), span_us / 1e6);
+  printf("targets         %zu\n", targets.size());
+  printf("actuated        %u\n", counts[OUTCOME_ACTUATED]);
+  printf("unchanged       %u\n", counts[OUTCOME_UNCHANGED]);
+  printf("superseded      %u\n", counts[OUTCOME_SUPERSEDED]);
+  printf("unreached       %u\n", counts[OUTCOME_UNREACHED]);
+  print_latencies("actuation", all);
+  for (std::map<std::string, std::vector<unsigned long long> >::const_iterator it = by_output.begin();
+       it != by_output.end(); ++it) {
+    print_latencies(("  " + it->first).c_str(), it->second);
+  }
+}
+
+// One line per target: "<event> <kind> <index> <value> <outcome> <latency us>"
+static void save_targets(const std::string& file_name, const std::vector<Target>& targets) {
+  FILE* file = fopen(file_name.c_str(), "w");
+  if (file == NULL) {
+    perror(file_name.c_str());
+    exit(1);
+  }
+  for (size_t t = 0; t < targets.size(); t++) {
+    fprintf(file, "%u %s %d %s %llu\n", targets[t].event, targets[t].output.c_str(), targets[t].value,
+            outcome_name(targets[t].outcome), targets[t].latency_us);
+  }
+  fclose(file);
+}
+
+// Compares against a saved run target by target. Returns how many differ.
+static unsigned compare_baseline(const std::string& file_name, const std::vector<Target>& targets,
+                                 unsigned long long tolerance_us) {
+  FILE* file = fopen(file_name.c_str(), "r");
+  if (file == NULL) {
+    perror(file_name.c_str());
+    exit(1);
+  }
+
+  // Keyed by event and output
+  std::map<std::string, std::pair<std::string, unsigned long long> > baseline;
+  std::vector<unsigned long long> baseline_latencies;
+  char line[128];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    unsigned event;
+    char kind[16];
+    unsigned index;
+    int value;
+    char outcome[16];
+    unsigned long long latency_us;
+    if (sscanf(line, "%u %15s %u %d %15s %llu", &event, kind, &index, &value, outcome, &latency_us) != 6) continue;
+    std::string key = std::to_string(event) + " " + kind + " " + std::to_string(index);
+    baseline[key] = std::make_pair(std::string(outcome), latency_us);
+    if (strcmp(outcome, "actuated") == 0) baseline_latencies.push_back(latency_us);
+  }
+  fclose(file);
+
+  unsigned differing = 0;
+  std::vector<unsigned long long> latencies;
+  printf("\nbaseline        %s\n", file_name.c_str());
+  for (size_t t = 0; t < targets.size(); t++) {
+    const Target& target = targets[t];
+    if (target.outcome == OUTCOME_ACTUATED) latencies.push_back(target.latency_us);
+
+    std::string key = std::to_string(target.event) + " " + target.output;
+    std::map<std::string, std::pair<std::string, unsigned long long> >::const_iterator it = baseline.find(key);
+    long long delta = it == baseline.end() ? 0 : (long long)target.latency_us - (long long)it->second.second;
+    bool same = it != baseline.end() && it->second.first == outcome_name(target.outcome) &&
+                (unsigned long long)(delta < 0 ? -delta : delta) <= tolerance_us;
+    if (same) continue;
+
+    if (differing++ < 20) {
+      if (it == baseline.end()) {
+        printf("  event %u %s: %s, not in baseline\n", target.event, target.output.c_str(),
+               outcome_name(target.outcome));
+      }
+      else {
+        printf("  event %u %s: %s %llu us -> %s %llu us (%+lld us)\n", target.event, target.output.c_str(),
+               it->second.first.c_str(), it->second.second, outcome_name(target.outcome), target.latency_us,
+               delta);
+      }
+    }
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  std::sort(baseline_latencies.begin(), baseline_latencies.end());
+  printf("differing       %u of %zu targets (tolerance %llu us)\n", differing, targets.size(), tolerance_us);
+  printf("p50 / p99  us   %llu / %llu -> %llu / %llu\n", percentile(baseline_latencies, 0.50),
+         percentile(baseline_latencies, 0.99), percentile(latencies, 0.50), percentile(latencies, 0.99));
+  return differing;
+}
+
+
+// ============================================================================
+//                                    MAIN
+// ============================================================================
+static void usage(const char* program) {
+  fprintf(stderr,
+          "usage: %s --firmware PATH --recording FILE [--realtime] [--timeline]\n"
+          "          [--save FILE] [--baseline FILE] [--tolerance-us N] [--verbose]\n", program);
+  exit(2);
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--realtime") options.realtime = true;
+    else if (arg == "--timeline") options.timeline = true;
+    else if (arg == "--verbose") options.verbose = true;
+    else if (i + 1 >= argc) usage(argv[0]);
+    else if (arg == "--firmware") options.firmware = argv[++i];
+    else if (arg == "--recording") options.recording = argv[++i];
+    else if (arg == "--save") options.save_file = argv[++i];
+    else if (arg == "--baseline") options.baseline_file = argv[++i];
+    else if (arg == "--tolerance-us") options.tolerance_us = strtoull(argv[++i], NULL, 10);
+    else usage(argv[0]);
+  }
+  if (options.firmware.empty() || options.recording.empty()) usage(argv[0]);
+  if (access(options.recording.c_str(), R_OK) != 0) {
+    perror(options.recording.c_str());
+    return 1;
+  }
+
+  std::string trace = run_replay(options);
+
+  std::vector<Event> events;
+  std::vector<Actuation> actuations;
+  size_t number = 0;
+  for (size_t start = 0, end; (end = trace.find('\n', start)) != std::string::npos; start = end + 1) {
+    parse_trace_line(number++, trace.substr(start, end - start).c_str(), events, actuations);
+  }
+  if (events.empty()) {
+    fprintf(stderr, "No events were replayed from %s\n", options.recording.c_str());
+    return 1;
+  }
+
+  std::vector<Target> targets;
+  for (size_t e = 0; e < events.size(); e++) event_targets(events[e], targets);
+  match_targets(targets, actuations);
+
+  if (options.timeline) print_timeline(events, actuations, events.front().time_us);
+  print_summary(events, targets, options);
+  if (!options.save_file.empty()) save_targets(options.save_file, targets);
+  if (!options.baseline_file.empty() && compare_baseline(options.baseline_file, targets, options.tolerance_us) > 0) {
+    return 1;
+  }
+  return 0;
+}